@@ -12,7 +12,38 @@
 #include <iostream>
 
 // SIMD vector libraries
-#if defined(VEC_INTEL) || defined(VEC_VC) || defined(VEC_VCL)
+#if defined(VEC_STDSIMD)
+//	#warning "Using std::experimental::simd (Parallelism TS 2)"
+	#include <experimental/simd>
+
+	// compile time constant with defaults
+	// native SIMD width of the target, as used by std::experimental::native_simd
+	#ifndef VEC_LENGTH
+		#if defined(__AVX512F__)
+			#define VEC_BYTES 64
+		#elif defined(__AVX__)
+			#define VEC_BYTES 32
+		#elif defined(__SSE2__) || defined(__ARM_NEON)
+			#define VEC_BYTES 16
+		#else
+			#error "VEC_STDSIMD: unknown native SIMD width, please define VEC_LENGTH"
+		#endif
+		#ifdef SINGLE_PRECISION
+			#define VEC_LENGTH (VEC_BYTES / 4)
+		#else
+			#define VEC_LENGTH (VEC_BYTES / 8)
+		#endif
+	#endif
+
+	// deduce_t yields the native ABI if VEC_LENGTH is the native width
+	#ifdef SINGLE_PRECISION
+	typedef std::experimental::native_simd<double> double_v;
+	typedef std::experimental::simd<float, std::experimental::simd_abi::deduce_t<float, VEC_LENGTH>> float_v;
+	#else
+	typedef std::experimental::simd<double, std::experimental::simd_abi::deduce_t<double, VEC_LENGTH>> double_v;
+	typedef std::experimental::native_simd<float> float_v;
+	#endif
+#elif defined(VEC_INTEL) || defined(VEC_VC) || defined(VEC_VCL)
 	#include <Vc/vector.h>
 	#include <vectorclass.h>
 	#ifdef __MIC__
@@ -22,9 +53,16 @@
 	#endif
 
 	// compile time constant with defaults
-	// assumed SIMD width (4 for Xeon, 8 for Xeon Phi)
+	// assumed SIMD width (4 for Xeon, 8 for Xeon Phi and AVX-512 Xeon)
 	#ifndef VEC_LENGTH
-		#ifdef SINGLE_PRECISION
+		#if defined(__AVX512F__) && !defined(__MIC__) && !defined(VEC_VC)
+			// Vc has no AVX-512 support, the other libraries are 8-wide
+			#ifdef SINGLE_PRECISION
+				#define VEC_LENGTH 16
+			#else
+				#define VEC_LENGTH 8
+			#endif
+		#elif defined(SINGLE_PRECISION)
 			#define VEC_LENGTH VC_FLOAT_V_SIZE // use Vc
 		#else
 			#define VEC_LENGTH VC_DOUBLE_V_SIZE // use Vc
@@ -34,12 +72,15 @@
 	// use one library to define real_vec_t
 	#ifdef VEC_INTEL
 //		#warning "Using Intel vector classes"
-		#ifdef __MIC__
+		#if defined(__MIC__) || defined(__AVX512F__)
 		typedef F64vec8 double_v;
 		typedef F32vec16 float_v;
-		#else
-		typedef F64vec4 double_v;;
+		#elif defined(__AVX__)
+		typedef F64vec4 double_v;
 		typedef F32vec8 float_v;
+		#else
+		typedef F64vec2 double_v;
+		typedef F32vec4 float_v;
 		#endif
 	#elif defined(VEC_VC)
 //		#warning "Using Vc"
@@ -48,7 +89,7 @@
 	#elif defined(VEC_VCL)
 #undef USE_VCL_ORIGINAL
 #if !defined(USE_VCL_ORIGINAL)
-#ifdef __MIC__
+#if defined(__MIC__) || defined(__AVX512F__)
 	#warning "Using VCL (Vector Class Library) with Vec8dMod"
 class Vec8dMod : public Vec8d {
 	public:
@@ -56,22 +97,32 @@ class Vec8dMod : public Vec8d {
 		friend Vec8d operator *(const Vec8dMod &a, const double &b) { return Vec8d(_mm512_mul_pd(a, _mm512_set1_pd(b))); } 
 };
 #define Vec8d Vec8dMod
-#else
+#elif defined(__AVX__)
 class Vec4dMod : public Vec4d {
 	public:
 		Vec4dMod(double d) : Vec4d(d) {}
 		friend Vec4d operator *(const Vec4dMod &a, const double &b) { return Vec4d(_mm256_mul_pd(a, _mm256_set1_pd(b))); } 
 };
 #define Vec4d Vec4dMod
+#else
+class Vec2dMod : public Vec2d {
+	public:
+		Vec2dMod(double d) : Vec2d(d) {}
+		friend Vec2d operator *(const Vec2dMod &a, const double &b) { return Vec2d(_mm_mul_pd(a, _mm_set1_pd(b))); } 
+};
+#define Vec2d Vec2dMod
 #endif
 #endif
 //		#warning "Using VCL (Vector Class Library)"
-		#ifdef __MIC__
+		#if defined(__MIC__) || defined(__AVX512F__)
 		typedef Vec8d double_v;
 		typedef Vec16f float_v;
-		#else
+		#elif defined(__AVX__)
 		typedef Vec4d double_v;
 		typedef Vec8f float_v;
+		#else
+		typedef Vec2d double_v;
+		typedef Vec4f float_v;
 		#endif
 	#endif
 #else
@@ -99,6 +150,16 @@ class Vec4dMod : public Vec4d {
 
 using complex_t = std::complex<real_t>;
 
+// the manual kernels index sigma in units of real_vec_t, VEC_LENGTH must match
+static_assert(sizeof(real_vec_t) == VEC_LENGTH * sizeof(real_t), "VEC_LENGTH does not match the width of real_vec_t");
+
+// native AVX-512 host kernels (*_avx512.cpp), packages must be 512 bit wide
+#if defined(__AVX512F__) && !defined(__MIC__)
+	#if (defined(SINGLE_PRECISION) && VEC_LENGTH == 16) || (!defined(SINGLE_PRECISION) && VEC_LENGTH == 8)
+		#define HOST_AVX512
+	#endif
+#endif
+
 // alignment for memory allocations
 #ifndef DEFAULT_ALIGNMENT
 	#define DEFAULT_ALIGNMENT 64
@@ -119,6 +180,10 @@ using complex_t = std::complex<real_t>;
 #ifndef NUM
 	#define NUM 512*1024
 #endif
+// number of Lindblad jump operators of the fused open-system kernels
+#ifndef NUM_JUMP_OPS
+	#define NUM_JUMP_OPS 2
+#endif
 
 #define STR_HELPER(x) #x
 #define STR(x) STR_HELPER(x)
@@ -146,6 +211,39 @@ void initialise_sigma(complex_t* sigma_in, complex_t* sigma_out, size_t dim, siz
 // initialise hamiltonian
 void initialise_hamiltonian(complex_t* hamiltonian, size_t dim);
 
+// Hermitian variants of the above for the kernels that rely on it, i.e. the
+// packed Hermitian layout, the eigenbasis and the effective hamiltonian of the
+// Lindblad kernels (the hamiltonian is real symmetric)
+void initialise_sigma_hermitian(complex_t* sigma_in, complex_t* sigma_out, size_t dim, size_t num);
+void initialise_hamiltonian_hermitian(complex_t* hamiltonian, size_t dim);
+
+// initialise num hamiltonians (AoS, one after another) with static disorder:
+// the hamiltonian of initialise_hamiltonian with deterministic pseudo-random
+// diagonal offsets per matrix
+void initialise_hamiltonians(complex_t* hamiltonians, size_t dim, size_t num);
+
+// initialise transition dipole operator (Hermitian, zero diagonal)
+void initialise_dipole(complex_t* dipole, size_t dim);
+
+// initialise num Lindblad jump operators (AoS, one after another), operator
+// l couples state i + l + 1 to state i with a state dependent phase
+void initialise_jump_operators(complex_t* jump_operators, size_t dim, size_t num);
+
+// initialise num diagonal, real Lindblad jump operators (pure dephasing)
+void initialise_dephasing_operators(complex_t* jump_operators, size_t dim, size_t num);
+
+// returns true if all imaginary parts of the matrix are zero, used to dispatch
+// to the real-Hamiltonian kernel specialisations
+bool is_real_matrix(complex_t const* matrix, size_t dim);
+
+// diagonalise a Hermitian matrix (cyclic Jacobi method): 
+//     matrix = eigenvectors * diag(eigenvalues) * eigenvectors^H
+// the columns of the unitary matrix eigenvectors are the eigenvectors
+void diagonalise_hermitian(complex_t const* matrix, size_t dim, real_t* eigenvalues, complex_t* eigenvectors);
+
+// replace matrix by its conjugate transpose
+void transform_matrix_conjugate_transpose(complex_t* matrix, size_t dim);
+
 // scale matrix by factor
 //void transform_matrix_scale_aos(complex_t* matrix, size_t dim, complex_t factor);
 void transform_matrix_scale_aos(complex_t* matrix, size_t dim, real_t factor);
@@ -159,6 +257,23 @@ void transform_matrix_scale_aos(complex_t* matrix, size_t dim, real_t factor);
 //     struct { real x[size], y[size]; } matrix;
 void transform_matrix_aos_to_soa(complex_t* matrix, size_t dim);
 
+// transform a complex AoS matrix into the tables used by the 3M (Gauss)
+// complex multiplication: RRR...(R+I)(R+I)(R+I)...(I-R)(I-R)(I-R)...
+// NOTE: the result has 3 * dim * dim reals, i.e. matrix must provide space
+//       for 1.5 * dim * dim complex numbers
+void transform_matrix_aos_to_soa_3m(complex_t* matrix, size_t dim);
+
+// effective non-Hermitian hamiltonian of the fused Lindblad kernels:
+// hamiltonian (pre-scaled by dt / hbar) becomes [A | A^H], both SoA, with
+// A = hamiltonian - i * dt / 2 * sum_l L_l^H L_l and the num_jump_operators
+// (unscaled, AoS) jump operators L_l
+// NOTE: hamiltonian must have room for 2 * dim * dim complex values
+void transform_matrix_aos_to_soa_lindblad(complex_t* hamiltonian, complex_t const* jump_operators, size_t num_jump_operators, size_t dim, real_t dt);
+
+// dephasing rates gamma_ij * dt of diagonal, real jump operators (unscaled, AoS),
+// i.e. their dissipator is -gamma_ij * sigma_ij, rates has dim * dim reals
+void dephasing_rates(complex_t const* jump_operators, size_t num_jump_operators, size_t dim, real_t dt, real_t* rates);
+
 // transform a vector of complex AoS matrices into an interleaved hybrid SoA
 // format (AoSoA) with an inner size of the SIMD-width specified by VEC_LENGTH
 // RIRIRI...RIRIRI... => RRR...III...RRR...III..
@@ -168,20 +283,37 @@ void transform_matrix_aos_to_soa(complex_t* matrix, size_t dim);
 // AoSoA: 
 //     struct complex_t { real x[VEC_LENGTH], y[VEC_LENGTH]; }; 
 //     complex_t matrix[size * num / VEC_LENGTH];
+// NOTE: in-place, package by package, num must be a multiple of vec_length
 void transform_matrices_aos_to_aosoa(complex_t* matrices, size_t dim, size_t num, size_t vec_length = VEC_LENGTH);
 
+// inverse of transform_matrices_aos_to_aosoa
+void transform_matrices_aosoa_to_aos(complex_t* matrices, size_t dim, size_t num, size_t vec_length = VEC_LENGTH);
+
 // similar to transform_matrices_aos_to_aosoa, but packs real and imaginary
 // parts of complex numbers differently:
 // stores packages of interleaved matrices, with all real parts of the package
 // preceding all the imaginare parts
 void transform_matrices_aos_to_aosoa_gpu(complex_t* matrices, size_t dim, size_t num, size_t vec_length = VEC_LENGTH);
 
+// inverse of transform_matrices_aos_to_aosoa_gpu
+void transform_matrices_aosoa_gpu_to_aos(complex_t* matrices, size_t dim, size_t num, size_t vec_length = VEC_LENGTH);
+
+// packed Hermitian variant of transform_matrices_aos_to_aosoa, only the upper
+// triangle is stored, the diagonal without its (zero) imaginary part:
+// Package:
+//     struct { real x[VEC_LENGTH]; } diagonal[dim];
+//     struct complex_t { real x[VEC_LENGTH], y[VEC_LENGTH]; } upper[dim * (dim - 1) / 2];
+// i.e. dim * dim reals per matrix instead of 2 * dim * dim, the data of the
+// packages occupies the first half of matrices, the rest is set to zero
+void transform_matrices_aos_to_aosoa_hermitian(complex_t* matrices, size_t dim, size_t num, size_t vec_length = VEC_LENGTH);
+
 // returns the sum of the absolute values of the element-wise differences as
 // measure of deviation
 real_t compare_matrices(complex_t* a, complex_t* b, size_t dim, size_t num);
 
-// benchmarks a kernel function and prints statistics to stdout
-void benchmark_kernel(std::function<void()> kernel, std::string name, size_t overall_runs, size_t warmup_runs);
+// benchmarks a kernel function and prints statistics to stdout, returns the
+// average runtime in nanoseconds
+double benchmark_kernel(std::function<void()> kernel, std::string name, size_t overall_runs, size_t warmup_runs);
 
 #endif // common_hpp
 
@@ -0,0 +1,69 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef heom_hpp
+#define heom_hpp
+
+#include "common.hpp"
+
+// Hierarchy of auxiliary density matrices (members) of the hierarchical
+// equations of motion (HEOM) for num_modes bath modes, each coupled to one
+// site via the projector V_k = |site_k><site_k|. A member is identified by
+// its occupation vector n (sum_k n_k <= depth) and couples to its neighbours
+// n + e_k (up) and n - e_k (down):
+//
+//     d/dt sigma_n = -i/hbar [H, sigma_n] - damping_n sigma_n
+//                    - i sum_k up_nk [V_k, sigma_{n+e_k}]
+//                    - i sum_k (down_nk V_k sigma_{n-e_k} - conj(down_nk) sigma_{n-e_k} V_k)
+//
+// All coefficients are pre-scaled by dt. A missing neighbour (beyond depth,
+// or n_k == 0) maps to the member itself with a zero coefficient, i.e. the
+// kernels gather without branches.
+struct heom_hierarchy
+{
+	int num_members;
+	int num_modes;
+	int depth;
+	int* site;          // [num_modes]
+	int* occupation;    // [num_members * num_modes], n_k of each member
+	int* neighbour;     // [num_members * 2 * num_modes], (up, down) per mode
+	real_t* coupling;   // [num_members * 3 * num_modes], (up, down_real, down_imag) per mode
+	real_t* damping;    // [num_members]
+};
+
+// builds the hierarchy of depth for num_modes modes on a dim-dimensional
+// system, members are ordered by level (sum_k n_k) and lexicographically within
+// a level, i.e. member 0 is the physical density matrix
+heom_hierarchy build_heom_hierarchy(int num_modes, int depth, int dim, real_t dt);
+
+void free_heom_hierarchy(heom_hierarchy& hierarchy);
+
+// number of members of a hierarchy: binomial(num_modes + depth, depth)
+size_t heom_hierarchy_size(int num_modes, int depth);
+
+// reverse Cuthill-McKee ordering of the members, i.e. of the graph with an
+// edge between each member and its neighbours, permutation[new] = old
+// NOTE: member 0 (the physical density matrix) is not kept in place
+void heom_rcm_permutation(heom_hierarchy const& hierarchy, int* permutation);
+
+// inverse[permutation[i]] = i
+void invert_permutation(int const* permutation, int* inverse, int size);
+
+// renumbers the members of hierarchy in place, member new is old member
+// permutation[new], all neighbour indices are updated
+void reorder_heom_hierarchy(heom_hierarchy& hierarchy, int const* permutation);
+
+// moves the packages (vec_length matrices, AoS or AoSoA) of each hierarchy in
+// matrices accordingly, i.e. package new is old package permutation[new]
+void permute_heom_members(complex_t* matrices, size_t dim, size_t num, size_t vec_length, int num_members, int const* permutation);
+
+// locality of the neighbour gathers in kernel order (one hierarchy, members
+// processed one after another): mean distance of a gathered package from the
+// current one, and the miss rate of the gathers in a modelled LRU cache that
+// holds cache_packages packages
+real_t heom_gather_distance(heom_hierarchy const& hierarchy);
+real_t heom_gather_miss_rate(heom_hierarchy const& hierarchy, size_t cache_packages);
+
+#endif // heom_hpp
@@ -11,6 +11,9 @@
 #ifndef VEC_LENGTH
 	#define VEC_LENGTH 8
 #endif
+#ifndef NUM_JUMP_OPS
+	#define NUM_JUMP_OPS 2
+#endif
 
 #ifdef SINGLE_PRECISION
 	#define FLOATVEC_HELPER(n) float ## n
@@ -0,0 +1,160 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef commutator_package_hpp
+#define commutator_package_hpp
+
+#include "common.hpp"
+
+// Building blocks that operate on a single AoSoA package of VEC_LENGTH sigma
+// matrices (2 * DIM * DIM vectors), used by the fused propagation kernels to
+// keep a package in L1/L2 across all stages of a time step.
+
+// number of vectors per package
+#define PACKAGE_SIZE (2 * DIM * DIM)
+
+// package_out += -i * [hamiltonian, package_in], hamiltonian is pre-scaled by
+// dt / hbar, same arithmetic as commutator_omp_manual_aosoa_constants_direct_perm
+inline void commutator_package(real_vec_t const* restrict package_in,
+                               real_vec_t* restrict package_out,
+                               real_t const* restrict hamiltonian)
+{
+	#define sigma_real(i, j) (2 * (DIM * (i) + (j)))
+	#define sigma_imag(i, j) (2 * (DIM * (i) + (j)) + 1)
+
+	#define ham_real(i, j) ((i) * DIM + (j))
+	#define ham_imag(i, j) (DIM * DIM + (i) * DIM + (j))
+
+	for (int i = 0; i < DIM; ++i)
+	{
+		for (int k = 0; k < DIM; ++k)
+		{
+			for (int j = 0; j < DIM; ++j)
+			{
+				package_out[sigma_imag(i,j)] -= package_in[sigma_real(k,j)] * hamiltonian[ham_real(i,k)];
+				package_out[sigma_imag(i,j)] += package_in[sigma_real(i,k)] * hamiltonian[ham_real(k,j)];
+				package_out[sigma_imag(i,j)] += package_in[sigma_imag(k,j)] * hamiltonian[ham_imag(i,k)];
+				package_out[sigma_imag(i,j)] -= package_in[sigma_imag(i,k)] * hamiltonian[ham_imag(k,j)];
+				package_out[sigma_real(i,j)] += package_in[sigma_imag(k,j)] * hamiltonian[ham_real(i,k)];
+				package_out[sigma_real(i,j)] -= package_in[sigma_real(i,k)] * hamiltonian[ham_imag(k,j)];
+				package_out[sigma_real(i,j)] += package_in[sigma_real(k,j)] * hamiltonian[ham_imag(i,k)];
+				package_out[sigma_real(i,j)] -= package_in[sigma_imag(i,k)] * hamiltonian[ham_real(k,j)];
+			}
+		}
+	}
+
+	#undef sigma_real
+	#undef sigma_imag
+	#undef ham_real
+	#undef ham_imag
+}
+
+// y = 0
+inline void zero_package(real_vec_t* restrict y)
+{
+	for (int i = 0; i < PACKAGE_SIZE; ++i)
+		y[i] = real_vec_t(real_t(0.0));
+}
+
+// y = x
+inline void copy_package(real_vec_t const* restrict x, real_vec_t* restrict y)
+{
+	for (int i = 0; i < PACKAGE_SIZE; ++i)
+		y[i] = x[i];
+}
+
+// y = a * y
+inline void scale_package(real_t a, real_vec_t* restrict y)
+{
+	for (int i = 0; i < PACKAGE_SIZE; ++i)
+		y[i] = y[i] * a;
+}
+
+// y += a * x
+inline void axpy_package(real_t a, real_vec_t const* restrict x, real_vec_t* restrict y)
+{
+	for (int i = 0; i < PACKAGE_SIZE; ++i)
+		y[i] += x[i] * a;
+}
+
+// z = y + a * x
+inline void axpyz_package(real_t a, real_vec_t const* restrict x, real_vec_t const* restrict y, real_vec_t* restrict z)
+{
+	for (int i = 0; i < PACKAGE_SIZE; ++i)
+		z[i] = y[i] + x[i] * a;
+}
+
+// one classical 4th order Runge-Kutta step of a package in place, with the
+// Hamiltonian pre-scaled by dt / hbar
+inline void rk4_step_package(real_vec_t* restrict package,
+                             real_t const* restrict hamiltonian)
+{
+	real_vec_t y[PACKAGE_SIZE]; // stage input
+	real_vec_t k[PACKAGE_SIZE]; // stage derivative
+	real_vec_t acc[PACKAGE_SIZE]; // weighted sum of the derivatives
+
+	// k1 = f(sigma)
+	zero_package(k);
+	commutator_package(package, k, hamiltonian);
+	copy_package(k, acc);
+	axpyz_package(0.5, k, package, y);
+
+	// k2 = f(sigma + k1 / 2)
+	zero_package(k);
+	commutator_package(y, k, hamiltonian);
+	axpy_package(2.0, k, acc);
+	axpyz_package(0.5, k, package, y);
+
+	// k3 = f(sigma + k2 / 2)
+	zero_package(k);
+	commutator_package(y, k, hamiltonian);
+	axpy_package(2.0, k, acc);
+	axpyz_package(1.0, k, package, y);
+
+	// k4 = f(sigma + k3), accumulated directly
+	commutator_package(y, acc, hamiltonian);
+
+	// sigma += (k1 + 2 * k2 + 2 * k3 + k4) / 6
+	axpy_package(1.0 / 6.0, acc, package);
+}
+
+// one step of the 2N-storage low-storage Runge-Kutta method with 5 stages and
+// 4th order (Carpenter and Kennedy, 1994) of a package in place:
+//     dq = A[s] * dq + f(sigma)
+//     sigma = sigma + B[s] * dq
+// the commutator accumulates directly into dq
+inline void lsrk_step_package(real_vec_t* restrict package,
+                              real_t const* restrict hamiltonian)
+{
+	const int num_stages = 5;
+	const real_t a[num_stages] = { 0.0,
+	                               -567301805773.0 / 1357537059087.0,
+	                               -2404267990393.0 / 2016746695238.0,
+	                               -3550918686646.0 / 2091501179385.0,
+	                               -1275806237668.0 / 842570457699.0 };
+	const real_t b[num_stages] = { 1432997174477.0 / 9575080441755.0,
+	                               5161836677717.0 / 13612068292357.0,
+	                               1720146321549.0 / 2090206949498.0,
+	                               3134564353537.0 / 4481467310338.0,
+	                               2277821191437.0 / 14882151754819.0 };
+
+	real_vec_t dq[PACKAGE_SIZE];
+
+	zero_package(dq); // a[0] == 0
+	for (int s = 0; s < num_stages; ++s)
+	{
+		if (s > 0)
+			scale_package(a[s], dq);
+		commutator_package(package, dq, hamiltonian);
+		axpy_package(b[s], dq, package);
+	}
+}
+
+// floating point operations per matrix and time step, i.e. the commutators
+// (8 multiply-adds per dim^3) plus the element-wise stage updates
+#define RK4_STEP_FLOPS (4 * 16 * DIM * DIM * DIM + 14 * 2 * DIM * DIM)
+#define LSRK_STEP_FLOPS (5 * 16 * DIM * DIM * DIM + 5 * 3 * 2 * DIM * DIM)
+
+#endif // commutator_package_hpp
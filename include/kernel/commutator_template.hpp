@@ -0,0 +1,98 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef commutator_template_hpp
+#define commutator_template_hpp
+
+#include <type_traits>
+#include <utility> // integer_sequence
+
+#include "common.hpp"
+
+// comma separated list of the matrix dimensions instantiated for the runtime
+// dispatch in commutator_omp_manual_aosoa_template, e.g. -DTEMPLATE_DIMS=4,7,8
+// NOTE: the code size, compile time and compiler memory of an instance grow
+//       with Dim^3, e.g. about 1.4 GB for all of 4..10 with g++ -O2
+#ifndef TEMPLATE_DIMS
+	#define TEMPLATE_DIMS DIM
+#endif
+
+// calls f(std::integral_constant<int, I>()) for I = 0..N-1, i.e. the loop is
+// unrolled at compile time and I is a constant expression inside f
+template<typename F, int... I>
+inline void static_for(F&& f, std::integer_sequence<int, I...>)
+{
+	using expand = int[];
+	(void)expand{ 0, (f(std::integral_constant<int, I>()), 0)... };
+}
+
+template<int N, typename F>
+inline void static_for(F&& f)
+{
+	static_for(f, std::make_integer_sequence<int, N>());
+}
+
+// fully unrolled commutator for compile-time Dim and vector type Vec, same
+// AoSoA layout and pre-scaled SoA Hamiltonian as the manual kernels,
+// a row of sigma_out is accumulated in registers
+template<int Dim, class Vec>
+void commutator_aosoa(Vec const* restrict sigma_in,
+                      Vec* restrict sigma_out,
+                      real_t const* restrict hamiltonian,
+                      const int num)
+{
+	constexpr int vec_length = sizeof(Vec) / sizeof(real_t);
+
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	for (int global_id = 0; global_id < (num / vec_length); ++global_id)
+	{
+		Vec const* restrict in = sigma_in + global_id * Dim * Dim * 2;
+		Vec* restrict out = sigma_out + global_id * Dim * Dim * 2;
+
+		static_for<Dim>([&](auto i)
+		{
+			Vec out_real[Dim];
+			Vec out_imag[Dim];
+			static_for<Dim>([&](auto j)
+			{
+				out_real[j] = out[2 * (Dim * i + j)];
+				out_imag[j] = out[2 * (Dim * i + j) + 1];
+			});
+
+			static_for<Dim>([&](auto k)
+			{
+				const real_t ham_real_ik = hamiltonian[i * Dim + k];
+				const real_t ham_imag_ik = hamiltonian[Dim * Dim + i * Dim + k];
+				const Vec sigma_real_ik = in[2 * (Dim * i + k)];
+				const Vec sigma_imag_ik = in[2 * (Dim * i + k) + 1];
+				static_for<Dim>([&](auto j)
+				{
+					const real_t ham_real_kj = hamiltonian[k * Dim + j];
+					const real_t ham_imag_kj = hamiltonian[Dim * Dim + k * Dim + j];
+					const Vec sigma_real_kj = in[2 * (Dim * k + j)];
+					const Vec sigma_imag_kj = in[2 * (Dim * k + j) + 1];
+
+					out_imag[j] -= sigma_real_kj * ham_real_ik;
+					out_imag[j] += sigma_real_ik * ham_real_kj;
+					out_imag[j] += sigma_imag_kj * ham_imag_ik;
+					out_imag[j] -= sigma_imag_ik * ham_imag_kj;
+					out_real[j] += sigma_imag_kj * ham_real_ik;
+					out_real[j] -= sigma_real_ik * ham_imag_kj;
+					out_real[j] += sigma_real_kj * ham_imag_ik;
+					out_real[j] -= sigma_imag_ik * ham_real_kj;
+				});
+			});
+
+			static_for<Dim>([&](auto j)
+			{
+				out[2 * (Dim * i + j)] = out_real[j];
+				out[2 * (Dim * i + j) + 1] = out_imag[j];
+			});
+		});
+	}
+}
+
+#endif // commutator_template_hpp
@@ -7,9 +7,19 @@
 #define kernel_hpp
 
 #include "common.hpp"
+#include "heom.hpp"
 
 void commutator_reference(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt);
 
+// one hamiltonian per sigma matrix (AoS, num_sigma matrices):
+void commutator_reference_batched(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonians, size_t dim, size_t num_sigma, real_t hbar, real_t dt);
+
+// time-dependent hamiltonian + field * dipole:
+void commutator_reference_field(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, complex_t* dipole, real_t field);
+
+// Lindblad equation, hamiltonian + dissipator of num_jump_operators jump operators:
+void commutator_reference_lindblad(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, complex_t* jump_operators, size_t num_jump_operators);
+
 #define SCALAR_PARAMETERS real_t const* restrict sigma_in,    \
                            real_t* restrict sigma_out,         \
                            real_t const* restrict hamiltonian, \
@@ -32,6 +42,9 @@ void commutator_omp_aosoa_constants_direct_perm2to3( SCALAR_PARAMETERS );
 
 void commutator_omp_aosoa_constants_direct_perm2to5( SCALAR_PARAMETERS );
 
+// real Hamiltonian (imaginary part is ignored):
+void commutator_omp_aosoa_constants_direct_perm_realham( SCALAR_PARAMETERS );
+
 # define VECTOR_PARAMETERS real_vec_t const* restrict sigma_in, \
                            real_vec_t* restrict sigma_out,      \
                            real_t const* restrict hamiltonian,  \
@@ -57,7 +70,113 @@ void commutator_omp_manual_aosoa_constants_direct_unrollhints( VECTOR_PARAMETERS
 
 void commutator_omp_manual_aosoa_constants_direct_perm_unrollhints( VECTOR_PARAMETERS );
 
+// real Hamiltonian (imaginary part is ignored):
+void commutator_omp_manual_aosoa_constants_direct_perm_realham( VECTOR_PARAMETERS );
+
+// one hamiltonian per package, i.e. per group of VEC_LENGTH sigma matrices,
+// package p uses hamiltonians + p * 2 * dim * dim (each pre-scaled,
+// transform_matrix_aos_to_soa):
+void commutator_omp_manual_aosoa_constants_direct_perm_batched(real_vec_t const* restrict sigma_in,
+                                                               real_vec_t* restrict sigma_out,
+                                                               real_t const* restrict hamiltonians,
+                                                               const int num, const int dim,
+                                                               const real_t hbar, const real_t dt);
+
+// table of hamiltonians (each pre-scaled, transform_matrix_aos_to_soa), package
+// p uses hamiltonians[hamiltonian_index[p]]:
+void commutator_omp_manual_aosoa_constants_direct_perm_indexed(real_vec_t const* restrict sigma_in,
+                                                               real_vec_t* restrict sigma_out,
+                                                               real_t const* restrict hamiltonians,
+                                                               int const* restrict hamiltonian_index,
+                                                               const int num, const int dim,
+                                                               const real_t hbar, const real_t dt);
+
+// time-dependent hamiltonian + field * dipole in a single pass over sigma, the
+// dipole operator has the layout and scaling of the hamiltonian, field is the
+// (unscaled) field amplitude of this call:
+void commutator_omp_manual_aosoa_constants_direct_perm_field( VECTOR_PARAMETERS,
+                                                              real_t const* restrict dipole,
+                                                              const real_t field );
+
+// Lindblad equation with NUM_JUMP_OPS jump operators fused with the commutator,
+// hamiltonian from transform_matrix_aos_to_soa_lindblad, jump_operators are
+// pre-scaled by sqrt(dt) (SoA, one after another):
+void commutator_omp_manual_aosoa_constants_lindblad( VECTOR_PARAMETERS,
+                                                     real_t const* restrict jump_operators );
+
+// Lindblad equation with diagonal, real jump operators (pure dephasing) fused
+// with the commutator, dephasing holds the dephasing_rates:
+void commutator_omp_manual_aosoa_constants_dephasing( VECTOR_PARAMETERS,
+                                                      real_t const* restrict dephasing );
+
+// 3M (Gauss) complex multiplication, hamiltonian from transform_matrix_aos_to_soa_3m:
+void commutator_omp_manual_aosoa_constants_3m( VECTOR_PARAMETERS );
+
+// fully unrolled template instances for the dims in TEMPLATE_DIMS (default: DIM),
+// selected at runtime:
+void commutator_omp_manual_aosoa_template( VECTOR_PARAMETERS );
+
+#ifdef HOST_AVX512
+// AVX-512 intrinsics, masked processing of a partial last package:
+void commutator_omp_manual_aosoa_constants_direct_perm_avx512( VECTOR_PARAMETERS );
+#endif
+
+// packed Hermitian sigma layout (transform_matrices_aos_to_aosoa_hermitian):
+void commutator_omp_manual_aosoa_constants_hermitian( VECTOR_PARAMETERS );
+
+// sigma in the eigenbasis of the Hamiltonian, hamiltonian are its eigenvalues:
+void commutator_omp_manual_aosoa_constants_eigenbasis( VECTOR_PARAMETERS );
+
+// in-place sigma = basis^H * sigma * basis, for all sigma matrices
+void basis_transform_omp_manual_aosoa_constants(real_vec_t* restrict sigma,
+                                                real_t const* restrict basis,
+                                                const int num, const int dim);
+
+// propagation of sigma in place by num_steps time steps:
+void propagate_reference_rk4(complex_t* sigma, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, size_t num_steps);
+
+void propagate_reference_lsrk(complex_t* sigma, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, size_t num_steps);
+
+#define PROPAGATE_PARAMETERS real_vec_t* restrict sigma,            \
+                             real_t const* restrict hamiltonian,    \
+                             const int num, const int dim,          \
+                             const int num_steps
+
+void propagate_omp_manual_aosoa_constants_rk4( PROPAGATE_PARAMETERS );
+
+void propagate_omp_manual_aosoa_constants_lsrk( PROPAGATE_PARAMETERS );
+
+// temporally blocked, each package is advanced by time_block steps at once:
+void propagate_omp_manual_aosoa_constants_rk4_blocked( PROPAGATE_PARAMETERS, const int time_block );
+
+void propagate_omp_manual_aosoa_constants_lsrk_blocked( PROPAGATE_PARAMETERS, const int time_block );
+
+// one persistent parallel region for all steps, synchronise != 0 adds a
+// sense-reversing barrier after each step:
+void propagate_omp_manual_aosoa_constants_rk4_persistent( PROPAGATE_PARAMETERS, const int synchronise );
+
+// hierarchical equations of motion (see heom.hpp), commutator and damping of
+// each member plus the coupling to its hierarchy neighbours:
+void heom_reference(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt,
+                    heom_hierarchy const& hierarchy, size_t vec_length);
+
+#define HEOM_PARAMETERS real_vec_t const* restrict sigma_in,     \
+                        real_vec_t* restrict sigma_out,          \
+                        real_t const* restrict hamiltonian,      \
+                        const int num, const int dim,            \
+                        int const* restrict neighbour,           \
+                        real_t const* restrict coupling,         \
+                        real_t const* restrict damping,          \
+                        int const* restrict site,                \
+                        const int num_members, const int num_modes
+
+// fused commutator, damping and neighbour coupling, neighbours are gathered
+// via the index table of the hierarchy:
+void heom_omp_manual_aosoa_constants( HEOM_PARAMETERS );
+
 #undef SCALAR_PARAMETERS
 #undef VECTOR_PARAMETERS
+#undef PROPAGATE_PARAMETERS
+#undef HEOM_PARAMETERS
 #endif // kernel_hpp
 
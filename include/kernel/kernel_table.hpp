@@ -0,0 +1,56 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef kernel_table_hpp
+#define kernel_table_hpp
+
+#include <cstddef>
+
+#include "common.hpp"
+
+// Runtime ISA dispatch (make_omp.sh -m):
+// src/kernel/kernel_table.cpp and all kernels are compiled once per ISA level
+// with a matching VEC_LENGTH, every kernel symbol gets the suffix _isa_<ISA name>.
+// Each compilation defines one kernel_table, the tables of the ISA levels that
+// were not built are null (weak symbols).
+
+// type-erased kernel signature, sigma is passed as real_t for all kernels, the
+// manual kernels reinterpret it as real_vec_t of the respective ISA level
+#define KERNEL_TABLE_PARAMETERS real_t const* sigma_in,    \
+                                real_t* sigma_out,         \
+                                real_t const* hamiltonian, \
+                                const int num, const int dim, \
+                                const real_t hbar, const real_t dt
+
+typedef void (*kernel_table_function)( KERNEL_TABLE_PARAMETERS );
+
+struct kernel_table_entry
+{
+	const char* name; // kernel name without ISA suffix
+	kernel_table_function kernel;
+	bool real_hamiltonian_only; // ignores the imaginary part of the Hamiltonian
+	bool hermitian_only; // requires Hermitian inputs (initialise_*_hermitian)
+	decltype(&transform_matrices_aos_to_aosoa) transformation_sigma;
+	decltype(&transform_matrix_aos_to_soa) transformation_hamiltonian;
+};
+
+struct kernel_table
+{
+	const char* isa;
+	size_t vec_length;
+	kernel_table_entry const* kernels;
+	size_t num_kernels;
+};
+
+extern const kernel_table kernel_table_sse42 __attribute__((weak));
+extern const kernel_table kernel_table_avx2 __attribute__((weak));
+extern const kernel_table kernel_table_avx512 __attribute__((weak));
+
+// returns the table of the best ISA level supported by the CPU (CPUID),
+// the environment variable HEXCITON_ISA=sse42|avx2|avx512 forces a level,
+// returns nullptr if no matching table was built
+kernel_table const* select_kernel_table();
+
+#endif // kernel_table_hpp
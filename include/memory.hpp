@@ -0,0 +1,97 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef memory_hpp
+#define memory_hpp
+
+#include "common.hpp"
+
+// NUMA-aware placement of the sigma arrays. Linux places a page on the NUMA
+// node of the thread that first writes it (first touch). allocate_numa()
+// does the first touch itself, with the static schedule of the kernels over
+// blocks of block_bytes (one AoSoA package by default), i.e. each package ends
+// up on the node of the thread that processes it, independent of how the
+// array is written later.
+// NOTE: partition, interleave and all node queries need libnuma (-DUSE_NUMA,
+//       -lnuma, make_omp.sh -n), without it there is a single node and both
+//       fall back to first_touch
+// NOTE: threads should be pinned (e.g. OMP_PROC_BIND=close), partition assumes
+//       the threads of node k are the k-th contiguous group of thread ids
+
+enum class numa_placement
+{
+	serial,      // touched by the calling thread, e.g. a serial memcpy/memset
+	first_touch, // touched by "omp parallel for schedule(static)" over the blocks
+	partition,   // one contiguous part per node (socket), bound to it, then first_touch
+	interleave   // pages round robin over all nodes
+};
+
+const char* numa_placement_name(numa_placement placement);
+
+// number of NUMA nodes, 1 without libnuma
+int numa_node_count();
+
+// binds the calling thread to the CPUs of node, -1 for all nodes
+void numa_bind_thread(int node);
+
+// page-aligned allocation of bytes, placed according to placement, free with free()
+void* allocate_numa_bytes(size_t bytes, numa_placement placement, size_t block_bytes);
+
+// page-aligned allocation of bytes with all pages on node, free with free()
+void* allocate_numa_bytes_on_node(size_t bytes, int node);
+
+template<typename T>
+T* allocate_numa(size_t size, numa_placement placement, size_t block_bytes = 2 * DIM * DIM * sizeof(real_vec_t))
+{
+	return static_cast<T*>(allocate_numa_bytes(size * sizeof(T), placement, block_bytes));
+}
+
+template<typename T>
+T* allocate_numa_on_node(size_t size, int node)
+{
+	return static_cast<T*>(allocate_numa_bytes_on_node(size * sizeof(T), node));
+}
+
+// fraction of the pages of [ptr, ptr + bytes) that are on the node of the
+// thread accessing them with schedule(static) over blocks of block_bytes,
+// 1 without libnuma
+double numa_local_fraction(void const* ptr, size_t bytes, size_t block_bytes = 2 * DIM * DIM * sizeof(real_vec_t));
+
+// Huge-page backed allocation of the sigma arrays, fewer TLB misses for the
+// kernels striding across them. The page size is selected at runtime, the one
+// actually obtained is returned, as the huge pages have to be reserved by the
+// administrator (vm.nr_hugepages, hugepagesz=1G on the kernel command line)
+// and transparent huge pages might be disabled.
+
+enum class page_size_kind
+{
+	normal,      // 4 KiB pages
+	transparent, // normal pages with madvise(MADV_HUGEPAGE), 2 MiB aligned
+	huge_2m,     // MAP_HUGETLB with 2 MiB pages, transparent as fallback
+	huge_1g      // MAP_HUGETLB with 1 GiB pages, then as huge_2m
+};
+
+const char* page_size_name(page_size_kind kind);
+
+// page size from the environment variable HEXCITON_PAGES (4k, thp, 2m, 1g),
+// normal if it is not set
+page_size_kind page_size_from_env();
+
+// mmap-backed, first-touched with the static schedule of the kernels (see
+// allocate_numa()), stores the size in bytes of the pages backing the
+// allocation in page_bytes if not nullptr, free with free_huge()
+void* allocate_huge_bytes(size_t bytes, page_size_kind kind, size_t* page_bytes = nullptr,
+                          size_t block_bytes = 2 * DIM * DIM * sizeof(real_vec_t));
+
+template<typename T>
+T* allocate_huge(size_t size, page_size_kind kind, size_t* page_bytes = nullptr)
+{
+	return static_cast<T*>(allocate_huge_bytes(size * sizeof(T), kind, page_bytes));
+}
+
+// frees memory from allocate_huge(), nullptr is ignored
+void free_huge(void* ptr);
+
+#endif // memory_hpp
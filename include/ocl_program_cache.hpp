@@ -0,0 +1,45 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ocl_program_cache_hpp
+#define ocl_program_cache_hpp
+
+#include <cstddef>
+#include <string>
+
+#include "clu_runtime/clu.h"
+
+// On-disk cache of OpenCL program binaries, to skip the kernel compilation at
+// startup. The key consists of the device (name, vendor, version), the driver
+// version, the compile options, and the source including all files it
+// includes via #include "..." (resolved against its directory and the -I
+// paths of the compile options, e.g. include/kernel/common.cl). Each cache
+// file stores its full key, i.e. any change of one of its parts is a miss
+// (automatic invalidation), as is a binary the runtime rejects.
+// The cache directory is taken from the environment variable
+// HEXCITON_OCL_CACHE, ".ocl_cache" if it is not set, an empty value disables
+// the cache.
+
+struct ocl_program_cache_statistics
+{
+	size_t hits;
+	size_t misses;
+	double build_ms; // time spent building from source (misses)
+	double load_ms;  // time spent creating and building from binaries (hits)
+};
+
+// builds the program in file_name for device, from a cached binary if
+// possible, otherwise from source, storing the binary afterwards
+// NOTE: err is set as by clBuildProgram(), cluGetBuildErrors() returns the
+//       build log on failure, nullptr is returned if no program could be
+//       created (e.g. the source could not be read), i.e. there is no log
+cl_program ocl_build_program_cached(cl_context context, cl_device_id device,
+                                    const std::string& file_name, const std::string& compile_options,
+                                    cl_int* err);
+
+// accumulated over all calls of ocl_build_program_cached()
+ocl_program_cache_statistics const& ocl_program_cache_stats();
+
+#endif // ocl_program_cache_hpp
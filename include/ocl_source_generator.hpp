@@ -0,0 +1,37 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ocl_source_generator_hpp
+#define ocl_source_generator_hpp
+
+#include <cstddef>
+#include <string>
+
+#include "common.hpp"
+
+// Runtime generation of an OpenCL commutator kernel specialised for one
+// Hamiltonian. The generated kernel is fully unrolled, every element of the
+// Hamiltonian is an immediate constant, and the coefficients of each sigma
+// element are summed up at generation time, i.e. terms that are zero or
+// cancel out (e.g. the diagonal of the Hamiltonian on the diagonal of sigma)
+// are not emitted. Worthwhile for long propagations with a constant, sparse
+// or structured Hamiltonian.
+// The kernel has the signature and the NDRange of
+// commutator_ocl_manual_aosoa_constants (AoSoA sigma, one package per
+// work-item), the hamiltonian argument is kept for that but not used.
+// NOTE: needs -Iinclude and the -D options of the other kernels to build
+
+struct ocl_generated_source
+{
+	std::string source;
+	size_t num_terms;      // multiply-adds emitted
+	size_t num_terms_full; // multiply-adds of the dense kernel, 8 * DIM^3
+};
+
+// hamiltonian: dim * dim, AoS, pre-scaled by dt / hbar
+ocl_generated_source ocl_generate_commutator_source(const std::string& kernel_name,
+                                                    complex_t const* hamiltonian, size_t dim);
+
+#endif // ocl_source_generator_hpp
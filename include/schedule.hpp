@@ -0,0 +1,91 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef schedule_hpp
+#define schedule_hpp
+
+#include <atomic>
+#include <thread> // yield
+
+#include "common.hpp"
+
+// Scheduling layer for kernels over AoSoA packages: the packages are split
+// into chunks that are handed to the threads of an OpenMP parallel region
+// according to a schedule. Used instead of a plain "omp parallel for" when the
+// cost per package varies (e.g. hierarchy truncation, sparse couplings, or
+// cores of different speed).
+
+// cache size a chunk of packages should fit into (per core, e.g. L2)
+#ifndef SCHEDULE_CACHE_BYTES
+	#define SCHEDULE_CACHE_BYTES (256 * 1024)
+#endif
+
+enum class schedule_kind
+{
+	omp_static,   // schedule(static), one contiguous block of chunks per thread
+	omp_dynamic,  // schedule(dynamic, 1) over chunks
+	omp_guided,   // schedule(guided, 1) over chunks
+	work_stealing // per-thread deques of contiguous chunks, idle threads steal
+	              // half of the remaining chunks of a victim
+};
+
+struct schedule
+{
+	schedule_kind kind;
+	int chunk_packages; // packages per chunk, <= 0 selects cache_chunk_packages()
+};
+
+const char* schedule_name(schedule_kind kind);
+
+// packages per chunk such that the chunk fits into cache_bytes
+int cache_chunk_packages(size_t bytes_per_package, size_t cache_bytes = SCHEDULE_CACHE_BYTES);
+
+// calls body(first, last) for all chunks [first, last) of [0, num_packages),
+// concurrently on all threads, optionally stores the time in seconds each
+// thread spent inside body in busy_time (omp_get_max_threads() values)
+// NOTE: body must not use OpenMP work-sharing itself
+void schedule_packages(schedule const& s, int num_packages, size_t bytes_per_package,
+                       std::function<void(int first, int last)> const& body,
+                       double* busy_time = nullptr);
+
+// Sense-reversing centralised barrier for persistent parallel regions, i.e.
+// without the fork/join of a new "omp parallel for" per time step. Each thread
+// keeps its own sense (initially false), the last thread to arrive resets the
+// counter and releases the others by flipping the global sense.
+struct sense_barrier
+{
+	alignas(64) std::atomic<int> count;
+	alignas(64) std::atomic<bool> sense; // separate cache line, spun on
+	int num_threads;
+
+	explicit sense_barrier(int num_threads = 1) : count(num_threads), sense(false), num_threads(num_threads) { }
+
+	// NOTE: not thread safe, call before the first wait(), e.g. in "omp single"
+	void reset(int threads)
+	{
+		num_threads = threads;
+		count.store(threads);
+		sense.store(false);
+	}
+
+	void wait(bool& local_sense)
+	{
+		local_sense = !local_sense;
+		if (count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			count.store(num_threads, std::memory_order_relaxed);
+			sense.store(local_sense, std::memory_order_release);
+		}
+		else
+		{
+			// yield now and then, in case there are more threads than cores
+			for (int spin = 1; sense.load(std::memory_order_acquire) != local_sense; ++spin)
+				if (spin % 1024 == 0)
+					std::this_thread::yield();
+		}
+	}
+};
+
+#endif // schedule_hpp
@@ -35,8 +35,10 @@ build()
 	local SUFFIX=$2
 	$CC -c $OPTIONS $CONFIG $INCLUDE -o ${BUILD_DIR}/common.o src/common.cpp 
 	$CC -c $OPTIONS $CONFIG $INCLUDE -o ${BUILD_DIR}/commutator_reference.o src/kernel/commutator_reference.cpp
+	$CC -c $OPTIONS $CONFIG $INCLUDE -o ${BUILD_DIR}/ocl_program_cache.o src/ocl_program_cache.cpp
+	$CC -c $OPTIONS $CONFIG $INCLUDE -o ${BUILD_DIR}/ocl_source_generator.o src/ocl_source_generator.cpp
 
-	$CC $OPTIONS $CONFIG $INCLUDE -o ${BUILD_DIR}/benchmark_ocl${SUFFIX} ${BUILD_DIR}/commutator_reference.o ${BUILD_DIR}/common.o src/benchmark_ocl.cpp $LIB
+	$CC $OPTIONS $CONFIG $INCLUDE -o ${BUILD_DIR}/benchmark_ocl${SUFFIX} ${BUILD_DIR}/commutator_reference.o ${BUILD_DIR}/common.o ${BUILD_DIR}/ocl_program_cache.o ${BUILD_DIR}/ocl_source_generator.o src/benchmark_ocl.cpp $LIB
 }
 
 usage ()
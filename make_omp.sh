@@ -14,15 +14,23 @@ VECCLASS_PATH_MIC=thirdparty/vcl_mic
 VECLIB="VEC_INTEL"
 #VECLIB="VEC_VC"
 #VECLIB="VEC_VCL"
+#VECLIB="VEC_STDSIMD" # std::experimental::simd, builds with g++ (see below)
 NUM_ITERATIONS=26 # including warmup below
 NUM_WARMUP=1
+TEMPLATE_DIMS="" # dims instantiated by the template kernel, e.g. 4,7,8 (default: DIM)
 
-OPTIONS="-std=c++11 -g -O3 -restrict -openmp -qopt-report=5" #-Wall
-#OPTIONS="-std=c++11 -g -O3 -restrict -openmp -qopt-report=5 -DUSE_INITZERO" #-Wall
+OPTIONS="-std=c++14 -g -O3 -restrict -openmp -qopt-report=5" #-Wall
+#OPTIONS="-std=c++14 -g -O3 -restrict -openmp -qopt-report=5 -DUSE_INITZERO" #-Wall
 OPTIONS_MIC="$OPTIONS -mmic"
 #OPTIONS_MIC="$OPTIONS_MIC -opt-prefetch-distance=6,1"
 OPTIONS_HOST="$OPTIONS -xHost"
 
+# NUMA-aware placement via libnuma (include/memory.hpp), host only, enabled
+# with -n (needs numa.h and libnuma)
+USE_NUMA=false
+NUMA_OPTIONS=""
+NUMA_LIB=""
+
 INCLUDE="-Iinclude -I${HAM_PATH}/include"
 INCLUDE_HOST="$INCLUDE -I${VC_PATH}/include -I${VECCLASS_PATH}"
 INCLUDE_MIC="$INCLUDE -I${VC_PATH}/include -I${VECCLASS_PATH_MIC}"
@@ -34,9 +42,28 @@ LIB_MIC="$LIB ${VC_PATH}/lib/libVc_MIC.a"
 BUILD_DIR_HOST="bin"
 BUILD_DIR_MIC="bin.mic"
 
-FILES=( \
+# ISA levels of the runtime dispatched CPU variant (-m), name:options:VEC_LENGTH
+# NOTE: the first entry is the baseline used for all non-kernel code, the names
+#       must match the tables in include/kernel/kernel_table.hpp
+ISAS=( "sse42:-xSSE4.2:2" "avx2:-xCORE-AVX2:4" "avx512:-xCORE-AVX512:8" )
+ISAS_GCC=( "sse42:-msse4.2:2" "avx2:-mavx2 -mfma:4" "avx512:-mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mfma:8" ) # gcc, clang
+OPTIONS_MULTI="$OPTIONS"
+BUILD_DIR_MULTI="bin"
+
+# non-kernel code, compiled once
+COMMON_FILES=( \
 common.cpp \
+schedule.cpp \
+memory.cpp \
 kernel/commutator_reference.cpp \
+kernel/propagate_reference.cpp \
+heom.cpp \
+kernel/heom_reference.cpp \
+)
+
+# kernels, compiled once per ISA level for -m, the function name must match the
+# file name
+KERNEL_FILES=( \
 kernel/commutator_omp_aosoa.cpp \
 kernel/commutator_omp_aosoa_constants.cpp \
 kernel/commutator_omp_aosoa_direct.cpp \
@@ -44,6 +71,7 @@ kernel/commutator_omp_aosoa_constants_direct.cpp \
 kernel/commutator_omp_aosoa_constants_direct_perm.cpp \
 kernel/commutator_omp_aosoa_constants_direct_perm2to3.cpp \
 kernel/commutator_omp_aosoa_constants_direct_perm2to5.cpp \
+kernel/commutator_omp_aosoa_constants_direct_perm_realham.cpp \
 kernel/commutator_omp_manual_aosoa.cpp \
 kernel/commutator_omp_manual_aosoa_constants.cpp \
 kernel/commutator_omp_manual_aosoa_constants_perm.cpp \
@@ -52,8 +80,28 @@ kernel/commutator_omp_manual_aosoa_constants_direct.cpp \
 kernel/commutator_omp_manual_aosoa_constants_direct_perm.cpp \
 kernel/commutator_omp_manual_aosoa_constants_direct_unrollhints.cpp \
 kernel/commutator_omp_manual_aosoa_constants_direct_perm_unrollhints.cpp \
+kernel/commutator_omp_manual_aosoa_constants_direct_perm_realham.cpp \
+kernel/commutator_omp_manual_aosoa_constants_direct_perm_avx512.cpp \
+kernel/commutator_omp_manual_aosoa_constants_3m.cpp \
+kernel/commutator_omp_manual_aosoa_constants_direct_perm_batched.cpp \
+kernel/commutator_omp_manual_aosoa_constants_direct_perm_indexed.cpp \
+kernel/commutator_omp_manual_aosoa_constants_direct_perm_field.cpp \
+kernel/commutator_omp_manual_aosoa_constants_lindblad.cpp \
+kernel/commutator_omp_manual_aosoa_constants_dephasing.cpp \
+kernel/commutator_omp_manual_aosoa_template.cpp \
+kernel/commutator_omp_manual_aosoa_constants_hermitian.cpp \
+kernel/commutator_omp_manual_aosoa_constants_eigenbasis.cpp \
+kernel/basis_transform_omp_manual_aosoa_constants.cpp \
+kernel/propagate_omp_manual_aosoa_constants_rk4.cpp \
+kernel/propagate_omp_manual_aosoa_constants_lsrk.cpp \
+kernel/propagate_omp_manual_aosoa_constants_rk4_blocked.cpp \
+kernel/propagate_omp_manual_aosoa_constants_lsrk_blocked.cpp \
+kernel/propagate_omp_manual_aosoa_constants_rk4_persistent.cpp \
+kernel/heom_omp_manual_aosoa_constants.cpp \
 )
 
+FILES=( "${COMMON_FILES[@]}" "${KERNEL_FILES[@]}" )
+
 # compile
 build()
 {
@@ -83,6 +131,68 @@ build()
 #	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_omp ${BUILD_DIR}/commutator_omp_manual_final.o ${BUILD_DIR}/commutator_omp_manual_aosoa_constants_direct.o  ${BUILD_DIR}/commutator_omp_auto_final.o ${BUILD_DIR}/commutator_reference.o ${BUILD_DIR}/common.o src/benchmark_omp.cpp $LIB
 
 	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_omp $OBJS src/benchmark_omp.cpp $LIB
+	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_propagation_omp $OBJS src/benchmark_propagation_omp.cpp $LIB
+	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_batched_omp $OBJS src/benchmark_batched_omp.cpp $LIB
+	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_heom_omp $OBJS src/benchmark_heom_omp.cpp $LIB
+	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_schedule_omp $OBJS src/benchmark_schedule_omp.cpp $LIB
+	$CC $OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_numa_omp $OBJS src/benchmark_numa_omp.cpp $LIB
+}
+
+# compile all kernels for each ISA level in ISAS into one binary with runtime
+# dispatch (src/dispatch.cpp)
+build_multi()
+{
+	local BUILD_DIR=$1
+	local OPTIONS=$2
+	local INCLUDE=$3
+	local LIB=$4
+
+	local OBJ_DIR=${BUILD_DIR}/multi_isa
+	mkdir -p $OBJ_DIR
+
+	local BASELINE_OPTIONS
+	IFS=':' read -r _ BASELINE_OPTIONS _ <<< "${ISAS[0]}"
+
+	# NOTE: the baseline objects are linked first, the linker keeps the first
+	#       definition of inline functions shared between the ISA levels (e.g.
+	#       from the standard library), which then runs on all CPUs
+	local OBJS=""
+	for file in "${COMMON_FILES[@]}" dispatch.cpp
+	do
+		local tmp=${file##*/}
+		local NAME=${tmp%.*}
+		$CC -c $OPTIONS $BASELINE_OPTIONS $INCLUDE -o ${OBJ_DIR}/${NAME}.o src/${file}
+		OBJS=" $OBJS ${OBJ_DIR}/${NAME}.o"
+	done
+
+	for isa in "${ISAS[@]}"
+	do
+		local ISA ISA_OPTIONS ISA_VEC_LENGTH
+		IFS=':' read -r ISA ISA_OPTIONS ISA_VEC_LENGTH <<< "$isa"
+
+		# suffix all kernel symbols with the ISA name
+		# NOTE: "_isa_" avoids chained renames, e.g. of foo -> foo_avx512 if
+		#       there is also a kernel foo_avx512
+		local RENAME=""
+		for file in "${KERNEL_FILES[@]}"
+		do
+			local tmp=${file##*/}
+			local NAME=${tmp%.*}
+			RENAME="$RENAME -D${NAME}=${NAME}_isa_${ISA}"
+		done
+
+		for file in "${KERNEL_FILES[@]}" kernel/kernel_table.cpp
+		do
+			local tmp=${file##*/}
+			local NAME=${tmp%.*}
+			$CC -c $OPTIONS $ISA_OPTIONS -DVEC_LENGTH=${ISA_VEC_LENGTH} -DKERNEL_ISA=${ISA} -DKERNEL_TABLE=kernel_table_${ISA} $RENAME $INCLUDE -o ${OBJ_DIR}/${NAME}_isa_${ISA}.o src/${file}
+			OBJS=" $OBJS ${OBJ_DIR}/${NAME}_isa_${ISA}.o"
+		done
+	done
+
+	echo $OBJS
+
+	$CC $OPTIONS $BASELINE_OPTIONS $INCLUDE -o ${BUILD_DIR}/benchmark_omp_dispatch $OBJS src/benchmark_omp_dispatch.cpp $LIB
 }
 
 usage ()
@@ -90,15 +200,18 @@ usage ()
 	echo "Usage and defaults:";
 	echo -e "\t-c\t Build CPU variant.";
 	echo -e "\t-a\t Build MIC (Accelerator) variant."; 
+	echo -e "\t-m\t Build CPU variant with runtime ISA dispatch (${ISAS[*]%%:*})."; 
+	echo -e "\t-n\t Use libnuma for NUMA-aware placement (host variants).";
 	echo -e "\t-i ${NUM_ITERATIONS}\t Number of iterations (including warmups).";
 	echo -e "\t-w ${NUM_WARMUP}\t Number of warmup iterations.";
-	echo -e "\t-v ${VECLIB}\t Vector library: VEC_INTEL | VEC_VC | VEC_VCL";        
+	echo -e "\t-t ${TEMPLATE_DIMS:-DIM}\t Dims of the template kernel, comma separated, e.g. 4,7,8.";
+	echo -e "\t-v ${VECLIB}\t Vector library: VEC_INTEL | VEC_VC | VEC_VCL | VEC_STDSIMD";        
 }
 
 BUILT_SOMETHING=false
 
 # evaluate command line
-while getopts ":i:w:v:cah" opt; do
+while getopts ":i:w:v:t:camnh" opt; do
 	case $opt in
 	i) # iterations
 		echo "Setting NUM_ITERATIONS to $OPTARG" >&2
@@ -108,6 +221,10 @@ while getopts ":i:w:v:cah" opt; do
 		echo "Setting NUM_WARMUP to $OPTARG" >&2
 		NUM_WARMUP=$OPTARG
 		;;
+	t) # template kernel dims
+		echo "Setting TEMPLATE_DIMS to $OPTARG" >&2
+		TEMPLATE_DIMS=$OPTARG
+		;;
 	v) # vec lib
 		echo "Setting VECLIB to $OPTARG" >&2
 		VECLIB=$OPTARG
@@ -120,6 +237,14 @@ while getopts ":i:w:v:cah" opt; do
 		echo "Building for Accelerator" >&2
 		BUILT_ACC=true
 		;;
+	m) # CPU, runtime ISA dispatch
+		echo "Building for CPU with runtime ISA dispatch" >&2
+		BUILT_MULTI=true
+		;;
+	n) # NUMA
+		echo "Using libnuma" >&2
+		USE_NUMA=true
+		;;
 	h) # usage
 		usage
 		exit 0
@@ -137,21 +262,55 @@ while getopts ":i:w:v:cah" opt; do
   esac
 done
 
+# std::experimental::simd requires C++17 and libstdc++ from GCC 11 or later
+if [ "$VECLIB" = "VEC_STDSIMD" ]
+then
+	CC=g++
+	OPTIONS="-std=c++17 -g -O3 -Drestrict=__restrict__ -fopenmp"
+	OPTIONS_HOST="$OPTIONS -march=native"
+	OPTIONS_MULTI="$OPTIONS"
+	ISAS=( "${ISAS_GCC[@]}" )
+	LIB_HOST="$LIB"
+	if [ "$BUILT_ACC" = "true" ]
+	then
+		echo "VEC_STDSIMD is not available for the MIC (Accelerator) variant."
+		exit 1
+	fi
+fi
+
+if [ "$USE_NUMA" = "true" ]
+then
+	NUMA_OPTIONS="-DUSE_NUMA"
+	NUMA_LIB="-lnuma"
+	LIB_HOST="$LIB_HOST $NUMA_LIB"
+fi
+
+if [ -n "$TEMPLATE_DIMS" ]
+then
+	TEMPLATE_OPTIONS="-DTEMPLATE_DIMS=${TEMPLATE_DIMS}"
+fi
+
 if [ "$BUILT_CPU" = "true" ]
 then
-	build "$BUILD_DIR_HOST" "$OPTIONS_HOST -DNUM_ITERATIONS=${NUM_ITERATIONS} -DNUM_WARMUP=${NUM_WARMUP} -D${VECLIB}" "$INCLUDE_HOST" "$LIB_HOST"
+	build "$BUILD_DIR_HOST" "$OPTIONS_HOST $NUMA_OPTIONS -DNUM_ITERATIONS=${NUM_ITERATIONS} -DNUM_WARMUP=${NUM_WARMUP} $TEMPLATE_OPTIONS -D${VECLIB}" "$INCLUDE_HOST" "$LIB_HOST"
 	BUILT_SOMETHING=true
 fi
 
 if [ "$BUILT_ACC" = "true" ]
 then
-	build "$BUILD_DIR_MIC" "$OPTIONS_MIC -DNUM_ITERATIONS=${NUM_ITERATIONS} -DNUM_WARMUP=${NUM_WARMUP} -D${VECLIB}" "$INCLUDE_MIC" "$LIB_MIC"
+	build "$BUILD_DIR_MIC" "$OPTIONS_MIC -DNUM_ITERATIONS=${NUM_ITERATIONS} -DNUM_WARMUP=${NUM_WARMUP} $TEMPLATE_OPTIONS -D${VECLIB}" "$INCLUDE_MIC" "$LIB_MIC"
+	BUILT_SOMETHING=true
+fi
+
+if [ "$BUILT_MULTI" = "true" ]
+then
+	build_multi "$BUILD_DIR_MULTI" "$OPTIONS_MULTI $NUMA_OPTIONS -DNUM_ITERATIONS=${NUM_ITERATIONS} -DNUM_WARMUP=${NUM_WARMUP} $TEMPLATE_OPTIONS -D${VECLIB}" "$INCLUDE_HOST" "$LIB_HOST"
 	BUILT_SOMETHING=true
 fi
 
 if [ "$BUILT_SOMETHING" = "false" ]
 then
-	echo "Please use at least one of -c -a";
+	echo "Please use at least one of -c -a -m";
 	usage
 fi
 
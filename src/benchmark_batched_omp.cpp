@@ -0,0 +1,164 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iostream>
+
+#include <cstring> // memcpy
+#include <cmath>
+
+#include "ham/util/time.hpp" // ham::util::time
+
+#include "common.hpp"
+#include "kernel/kernel.hpp"
+
+using namespace ham::util;
+
+// number of distinct hamiltonians in the table of the indexed kernel
+#ifndef NUM_HAMILTONIANS
+	#define NUM_HAMILTONIANS 16
+#endif
+
+int main(void)
+{
+	print_compile_config(std::cerr);
+	std::cerr << "NUM_HAMILTONIANS: " << NUM_HAMILTONIANS << std::endl;
+
+	// constants
+	const size_t dim = DIM;
+	const size_t num = NUM;
+	const size_t num_packages = num / VEC_LENGTH;
+	const size_t num_hamiltonians = NUM_HAMILTONIANS;
+	const real_t hbar = 1.0 / std::acos(-1.0); // == 1 / Pi
+	const real_t dt = 1.0e-3; 
+
+	real_t deviation = 0.0;
+
+	// allocate memory
+	size_t size_hamiltonian = dim * dim;
+	size_t size_sigma = size_hamiltonian * num;
+
+	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* hamiltonians = allocate_aligned<complex_t>(size_sigma); // one per sigma, for the reference
+	complex_t* hamiltonian_packages = allocate_aligned<complex_t>(size_hamiltonian * num_packages); // one per package
+	complex_t* hamiltonian_table = allocate_aligned<complex_t>(size_hamiltonian * num_hamiltonians);
+	int* hamiltonian_index = allocate_aligned<int>(num_packages);
+	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
+
+	// print output header
+	std::cout << "name\t" << time::statistics::header_string() << std::endl;
+
+	// Lambda to: initialise and transform memory, benchmark, compare results
+	// NOTE: hamiltonians holds the per-sigma AoS hamiltonians for the reference,
+	//       transform_hamiltonians is applied after the reference used them
+	auto benchmark = [&](std::function<void()> kernel, std::string name,
+	                     std::function<void()> transform_hamiltonians)
+	{
+		// reference computation with the same number of runs as the kernel
+		initialise_sigma(sigma_in, sigma_reference, dim, num);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_reference_batched(sigma_in, sigma_reference, hamiltonians, dim, num, hbar, dt);
+			},
+			"commutator_reference_batched",
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+		transform_matrices_aos_to_aosoa(sigma_reference, dim, num, VEC_LENGTH);
+		transform_hamiltonians();
+
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+		transform_matrices_aos_to_aosoa(sigma_out, dim, num, VEC_LENGTH);
+
+		benchmark_kernel(kernel, name, NUM_ITERATIONS, NUM_WARMUP);
+
+		// compute deviation from reference	(small deviations are expected)
+		deviation = compare_matrices(sigma_out, sigma_reference, dim, num);
+		std::cerr << "Deviation:\t" << deviation << std::endl;
+	};
+
+	// BENCHMARK: one shared hamiltonian for all sigma matrices as baseline
+	initialise_hamiltonian(hamiltonian, dim);
+	for (size_t m = 0; m < num; ++m)
+		std::memcpy(hamiltonians + m * size_hamiltonian, hamiltonian, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian, dim);
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm(
+				reinterpret_cast<real_vec_t*>(sigma_in),
+				reinterpret_cast<real_vec_t*>(sigma_out),
+				reinterpret_cast<real_t*>(hamiltonian),
+				num, dim, hbar, dt);
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm",
+		[]() {});
+
+	// BENCHMARK: one hamiltonian per package, stored in package order, i.e.
+	//            1 / VEC_LENGTH of the sigma data is streamed in addition
+	initialise_hamiltonians(hamiltonian_packages, dim, num_packages);
+	for (size_t p = 0; p < num_packages; ++p)
+	{
+		for (size_t v = 0; v < VEC_LENGTH; ++v)
+			std::memcpy(hamiltonians + (p * VEC_LENGTH + v) * size_hamiltonian,
+			            hamiltonian_packages + p * size_hamiltonian,
+			            sizeof(complex_t) * size_hamiltonian);
+		transform_matrix_scale_aos(hamiltonian_packages + p * size_hamiltonian, dim, dt / hbar);
+		transform_matrix_aos_to_soa(hamiltonian_packages + p * size_hamiltonian, dim);
+	}
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm_batched(
+				reinterpret_cast<real_vec_t*>(sigma_in),
+				reinterpret_cast<real_vec_t*>(sigma_out),
+				reinterpret_cast<real_t*>(hamiltonian_packages),
+				num, dim, hbar, dt);
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm_batched",
+		[]() {});
+
+	// BENCHMARK: table of NUM_HAMILTONIANS hamiltonians, one index per package
+	initialise_hamiltonians(hamiltonian_table, dim, num_hamiltonians);
+	for (size_t p = 0; p < num_packages; ++p)
+	{
+		hamiltonian_index[p] = (p * 7) % num_hamiltonians;
+		for (size_t v = 0; v < VEC_LENGTH; ++v)
+			std::memcpy(hamiltonians + (p * VEC_LENGTH + v) * size_hamiltonian,
+			            hamiltonian_table + hamiltonian_index[p] * size_hamiltonian,
+			            sizeof(complex_t) * size_hamiltonian);
+	}
+	for (size_t h = 0; h < num_hamiltonians; ++h)
+	{
+		transform_matrix_scale_aos(hamiltonian_table + h * size_hamiltonian, dim, dt / hbar);
+		transform_matrix_aos_to_soa(hamiltonian_table + h * size_hamiltonian, dim);
+	}
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm_indexed(
+				reinterpret_cast<real_vec_t*>(sigma_in),
+				reinterpret_cast<real_vec_t*>(sigma_out),
+				reinterpret_cast<real_t*>(hamiltonian_table),
+				hamiltonian_index,
+				num, dim, hbar, dt);
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm_indexed",
+		[]() {});
+
+	free(hamiltonian);
+	free(hamiltonians);
+	free(hamiltonian_packages);
+	free(hamiltonian_table);
+	free(hamiltonian_index);
+	free(sigma_in);
+	free(sigma_out);
+	free(sigma_reference);
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iostream>
+
+#include <algorithm> // max
+#include <cstring> // memcpy
+#include <cmath>
+#include <string>
+
+#include "ham/util/time.hpp" // ham::util::time
+
+#include "common.hpp"
+#include "heom.hpp"
+#include "kernel/kernel.hpp"
+
+using namespace ham::util;
+
+// range of benchmarked hierarchy depths
+#ifndef HEOM_DEPTH_MIN
+	#define HEOM_DEPTH_MIN 2
+#endif
+#ifndef HEOM_DEPTH_MAX
+	#define HEOM_DEPTH_MAX 5
+#endif
+// number of bath modes (one per site by default)
+#ifndef HEOM_MODES
+	#define HEOM_MODES DIM
+#endif
+// cache size of the gather locality model (per core, e.g. L2)
+#ifndef HEOM_CACHE_BYTES
+	#define HEOM_CACHE_BYTES (1024 * 1024)
+#endif
+
+int main(void)
+{
+	print_compile_config(std::cerr);
+	std::cerr << "HEOM_DEPTH_MIN: " << HEOM_DEPTH_MIN << std::endl;
+	std::cerr << "HEOM_DEPTH_MAX: " << HEOM_DEPTH_MAX << std::endl;
+	std::cerr << "HEOM_MODES: " << HEOM_MODES << std::endl;
+	std::cerr << "HEOM_CACHE_BYTES: " << HEOM_CACHE_BYTES << std::endl;
+
+	// constants
+	const size_t dim = DIM;
+	const real_t hbar = 1.0 / std::acos(-1.0); // == 1 / Pi
+	const real_t dt = 1.0e-3; 
+
+	real_t deviation = 0.0;
+	const size_t cache_packages = HEOM_CACHE_BYTES / (2 * DIM * DIM * sizeof(real_vec_t));
+
+	size_t size_hamiltonian = dim * dim;
+	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* hamiltonian_scaled = allocate_aligned<complex_t>(size_hamiltonian);
+
+	initialise_hamiltonian(hamiltonian, dim);
+	std::memcpy(hamiltonian_scaled, hamiltonian, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_scale_aos(hamiltonian_scaled, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian_scaled, dim);
+
+	// print output header
+	std::cout << "name\t" << time::statistics::header_string() << std::endl;
+
+	for (int depth = HEOM_DEPTH_MIN; depth <= HEOM_DEPTH_MAX; ++depth)
+	{
+		heom_hierarchy hierarchy = build_heom_hierarchy(HEOM_MODES, depth, dim, dt);
+
+		// as many whole hierarchies of VEC_LENGTH systems as fit into NUM matrices
+		const size_t num_hierarchies = std::max<size_t>(1, NUM / (VEC_LENGTH * hierarchy.num_members));
+		const size_t num = num_hierarchies * hierarchy.num_members * VEC_LENGTH;
+		std::cerr << "Depth: " << depth << ", members: " << hierarchy.num_members
+		          << ", hierarchies: " << num_hierarchies << ", matrices: " << num << std::endl;
+
+		size_t size_sigma = size_hamiltonian * num;
+		complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
+		complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma);
+		complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
+
+		// BENCHMARK: commutator only as baseline, no validation
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_omp_manual_aosoa_constants_direct_perm(
+					reinterpret_cast<real_vec_t*>(sigma_in),
+					reinterpret_cast<real_vec_t*>(sigma_out),
+					reinterpret_cast<real_t*>(hamiltonian_scaled),
+					num, dim, 0.0, 0.0);
+			},
+			"commutator_omp_manual_aosoa_constants_direct_perm_depth" + std::to_string(depth),
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+
+		// reference computation with the same number of runs as the kernel
+		initialise_sigma(sigma_in, sigma_reference, dim, num);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				heom_reference(sigma_in, sigma_reference, hamiltonian, dim, num, hbar, dt, hierarchy, VEC_LENGTH);
+			},
+			"heom_reference_depth" + std::to_string(depth),
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+		transform_matrices_aos_to_aosoa(sigma_reference, dim, num, VEC_LENGTH);
+
+		// Lambda to: benchmark the fused kernel for a hierarchy, compare results
+		auto benchmark = [&](heom_hierarchy const& h, std::string name, int const* permutation, int const* inverse)
+		{
+			std::cerr << "Gather distance (packages):\t" << heom_gather_distance(h) << std::endl;
+			std::cerr << "Gather miss rate (LRU model, " << cache_packages << " packages):\t"
+			          << heom_gather_miss_rate(h, cache_packages) << std::endl;
+
+			initialise_sigma(sigma_in, sigma_out, dim, num);
+			transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+			if (permutation)
+				permute_heom_members(sigma_in, dim, num, VEC_LENGTH, h.num_members, permutation);
+			benchmark_kernel(
+				[&]() // lambda expression
+				{
+					heom_omp_manual_aosoa_constants(
+						reinterpret_cast<real_vec_t*>(sigma_in),
+						reinterpret_cast<real_vec_t*>(sigma_out),
+						reinterpret_cast<real_t*>(hamiltonian_scaled),
+						num, dim,
+						h.neighbour, h.coupling, h.damping, h.site,
+						h.num_members, h.num_modes);
+				},
+				name + "_depth" + std::to_string(depth),
+				NUM_ITERATIONS,
+				NUM_WARMUP);
+			// back to the original order for the output
+			if (inverse)
+				permute_heom_members(sigma_out, dim, num, VEC_LENGTH, h.num_members, inverse);
+
+			// compute deviation from reference	(small deviations are expected)
+			deviation = compare_matrices(sigma_out, sigma_reference, dim, num);
+			std::cerr << "Deviation:\t" << deviation << std::endl;
+		};
+
+		// BENCHMARK: fused commutator and hierarchy coupling, members by level
+		benchmark(hierarchy, "heom_omp_manual_aosoa_constants", nullptr, nullptr);
+
+		// BENCHMARK: same, members in reverse Cuthill-McKee order
+		{ // keep things local
+		int* permutation = allocate_aligned<int>(hierarchy.num_members);
+		int* inverse = allocate_aligned<int>(hierarchy.num_members);
+		heom_rcm_permutation(hierarchy, permutation);
+		invert_permutation(permutation, inverse, hierarchy.num_members);
+
+		heom_hierarchy hierarchy_rcm = build_heom_hierarchy(HEOM_MODES, depth, dim, dt);
+		reorder_heom_hierarchy(hierarchy_rcm, permutation);
+		benchmark(hierarchy_rcm, "heom_omp_manual_aosoa_constants_rcm", permutation, inverse);
+
+		free_heom_hierarchy(hierarchy_rcm);
+		free(permutation);
+		free(inverse);
+		}
+
+		free(sigma_in);
+		free(sigma_out);
+		free(sigma_reference);
+		free_heom_hierarchy(hierarchy);
+	}
+
+	free(hamiltonian);
+	free(hamiltonian_scaled);
+
+	return 0;
+}
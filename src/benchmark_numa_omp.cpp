@@ -0,0 +1,144 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iostream>
+
+#include <cstring> // memcpy
+#include <cmath>
+#include <string>
+
+#include "ham/util/time.hpp" // ham::util::time
+
+#include "common.hpp"
+#include "memory.hpp"
+#include "kernel/kernel.hpp"
+
+using namespace ham::util;
+
+int main(void)
+{
+	print_compile_config(std::cerr);
+	const int num_nodes = numa_node_count();
+	std::cerr << "NUMA nodes: " << num_nodes << std::endl;
+
+	// constants
+	const size_t dim = DIM;
+	const size_t num = NUM;
+	const real_t hbar = 1.0 / std::acos(-1.0); // == 1 / Pi
+	const real_t dt = 1.0e-3;
+
+	real_t deviation = 0.0;
+
+	size_t size_hamiltonian = dim * dim;
+	size_t size_sigma = size_hamiltonian * num;
+	size_t size_sigma_byte = sizeof(complex_t) * size_sigma;
+
+	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* hamiltonian_scaled = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
+
+	initialise_hamiltonian(hamiltonian, dim);
+	std::memcpy(hamiltonian_scaled, hamiltonian, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_scale_aos(hamiltonian_scaled, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian_scaled, dim);
+
+	// print output header
+	std::cout << "name\t" << time::statistics::header_string() << std::endl;
+
+	// achieved bandwidth, average runtime is in ns
+	auto print_bandwidth = [&](double bytes, double runtime)
+	{
+		std::cerr << "Bandwidth (GB/s):\t" << bytes / runtime << std::endl;
+	};
+
+	// BENCHMARK: local vs remote read bandwidth, threads bound to cpu_node,
+	//            memory on mem_node
+	for (int cpu_node = 0; cpu_node < num_nodes; ++cpu_node)
+	{
+		#pragma omp parallel
+		numa_bind_thread(cpu_node);
+
+		for (int mem_node = 0; mem_node < num_nodes; ++mem_node)
+		{
+			const size_t size = size_sigma_byte / sizeof(real_t);
+			real_t* data = allocate_numa_on_node<real_t>(size, mem_node);
+			real_t sum = 0.0;
+			print_bandwidth(size_sigma_byte,
+				benchmark_kernel(
+					[&]() // lambda expression
+					{
+						real_t s = 0.0;
+						#pragma omp parallel for reduction(+:s)
+						for (size_t i = 0; i < size; ++i)
+							s += data[i];
+						sum += s;
+					},
+					std::string(cpu_node == mem_node ? "read_local" : "read_remote")
+						+ "_cpu" + std::to_string(cpu_node) + "_mem" + std::to_string(mem_node),
+					NUM_ITERATIONS,
+					NUM_WARMUP));
+			if (sum != 0.0) // zeroed memory, keeps the loop from being removed
+				std::cerr << "Error: read sum is not zero: " << sum << std::endl;
+			free(data);
+		}
+	}
+	#pragma omp parallel
+	numa_bind_thread(-1);
+
+	// reference computation with the same number of runs as the kernels
+	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
+	initialise_sigma(sigma_in, sigma_reference, dim, num);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_reference(sigma_in, sigma_reference, hamiltonian, dim, num, hbar, dt);
+		},
+		"commutator_reference",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	transform_matrices_aos_to_aosoa(sigma_reference, dim, num, VEC_LENGTH);
+	free(sigma_in);
+
+	// BENCHMARK: commutator with the sigma arrays placed according to placement,
+	//            bandwidth for reading sigma_in and updating sigma_out
+	for (numa_placement placement : { numa_placement::serial, numa_placement::first_touch,
+	                                  numa_placement::partition, numa_placement::interleave })
+	{
+		complex_t* sigma_in = allocate_numa<complex_t>(size_sigma, placement);
+		complex_t* sigma_out = allocate_numa<complex_t>(size_sigma, placement);
+		std::cerr << "Local pages (" << numa_placement_name(placement) << "):\t"
+		          << numa_local_fraction(sigma_in, size_sigma_byte) << "\t"
+		          << numa_local_fraction(sigma_out, size_sigma_byte) << std::endl;
+
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+		print_bandwidth(3.0 * size_sigma_byte,
+			benchmark_kernel(
+				[&]() // lambda expression
+				{
+					commutator_omp_manual_aosoa_constants_direct_perm(
+						reinterpret_cast<real_vec_t*>(sigma_in),
+						reinterpret_cast<real_vec_t*>(sigma_out),
+						reinterpret_cast<real_t*>(hamiltonian_scaled),
+						num, dim, 0.0, 0.0);
+				},
+				std::string("commutator_omp_manual_aosoa_constants_direct_perm_") + numa_placement_name(placement),
+				NUM_ITERATIONS,
+				NUM_WARMUP));
+
+		// compute deviation from reference	(small deviations are expected)
+		deviation = compare_matrices(sigma_out, sigma_reference, dim, num);
+		std::cerr << "Deviation:\t" << deviation << std::endl;
+
+		free(sigma_in);
+		free(sigma_out);
+	}
+
+	free(hamiltonian);
+	free(hamiltonian_scaled);
+	free(sigma_reference);
+
+	return 0;
+}
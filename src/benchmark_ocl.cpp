@@ -5,15 +5,20 @@
 
 #include <iostream>
 
+#include <algorithm> // min
 #include <cstring> // memcpy
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "clu_runtime/clu.h"
 #include "ham/util/time.hpp" // ham::util::time
 
 #include "common.hpp"
+#include "ocl_program_cache.hpp"
+#include "ocl_source_generator.hpp"
 #include "kernel/kernel.hpp"
 
 using namespace ham::util;
@@ -39,6 +44,32 @@ using namespace ham::util;
 #ifndef WARP_SIZE
 	#define WARP_SIZE 32
 #endif
+// number of package-aligned chunks and in-order queues of the pipelined mode
+#ifndef PIPELINE_CHUNKS
+	#define PIPELINE_CHUNKS 8
+#endif
+#ifndef PIPELINE_QUEUES
+	#define PIPELINE_QUEUES 2
+#endif
+// additionally benchmark each kernel end-to-end with explicit copies,
+// CL_MEM_USE_HOST_PTR buffers and fine-grained SVM (0 to disable)
+#ifndef END_TO_END
+	#define END_TO_END 1
+#endif
+// additionally run each kernel benchmark with all runs enqueued back-to-back
+// and a single final wait (0 to disable)
+#ifndef BACK_TO_BACK
+	#define BACK_TO_BACK 1
+#endif
+// number of distinct hamiltonians in the table of the indexed kernel
+#ifndef NUM_HAMILTONIANS
+	#define NUM_HAMILTONIANS 16
+#endif
+// alignment of the host sigma arrays, zero-copy CL_MEM_USE_HOST_PTR buffers
+// need page-aligned memory with most runtimes
+#ifndef HOST_PTR_ALIGNMENT
+	#define HOST_PTR_ALIGNMENT 4096
+#endif
 
 bool ocl_error_handler(cl_int err, const std::string& function_name, bool terminate = true)
 {
@@ -52,33 +83,124 @@ bool ocl_error_handler(cl_int err, const std::string& function_name, bool termin
 	return error;
 }
 
-void benchmark_ocl_kernel(cl_kernel kernel, std::string name, clu_nd_range range, size_t num, size_t overall_runs, size_t warmup_runs)
+// profiling counter of a completed event
+cl_ulong ocl_event_time(cl_event event, cl_profiling_info param)
+{
+	cl_ulong time = 0;
+	cl_int err = clGetEventProfilingInfo(event, param, sizeof(cl_ulong), &time, nullptr);
+	ocl_error_handler(err, "clGetEventProfilingInfo()");
+	return time;
+}
+
+// prints the wall-clock throughput of runs kernel runs over num matrices each
+void print_throughput(size_t runs, size_t num, time::rep wall_time)
+{
+	std::cerr << "Throughput (matrices/s):\t" << (runs * num) / (wall_time * 1.0e-9) << std::endl;
+}
+
+// Benchmarks kernel in two ways:
+//     synchronous: one host round trip per run, i.e. enqueue and wait,
+//                  reports the kernel runtime (start to end) as name, and
+//                  name_queued_to_start (queueing and launch latency of the
+//                  runtime) and name_submit (host time spent in the enqueue
+//                  call)
+//     back-to-back: all runs enqueued before a single final wait, reports
+//                   name_back_to_back, the time between the ends of two
+//                   consecutive kernels, i.e. the runtime including the launch
+//                   gaps (BACK_TO_BACK=0 to disable), output (the buffer the
+//                   kernel writes) is restored afterwards, i.e. it holds the
+//                   result of the synchronous runs for the comparison
+// the wall-clock throughput of both modes is written to std::cerr
+void benchmark_ocl_kernel(cl_kernel kernel, std::string name, clu_nd_range range, size_t num, size_t overall_runs, size_t warmup_runs, cl_mem output)
 {
 	cl_int err = 0;
 	cl_event event;
-	cl_ulong t_start = 0;
-	cl_ulong t_end = 0;
 	clu_enqueue_params params = { range, CLU_DEFAULT_Q, 0, nullptr, &event };
 
 	// benchmark loop
 	time::statistics stats(overall_runs, warmup_runs);
+	time::statistics stats_queued(overall_runs, warmup_runs);
+	time::statistics stats_submit(overall_runs, warmup_runs);
+	time::rep wall_time = 0;
 	for (size_t i = 0; i < overall_runs; ++i)
 	{
 		// execute kernel
-		cluEnqueue(kernel, &params);
+		time::timer t;
+		err = cluEnqueue(kernel, &params);
+		stats_submit.add(t);
 		ocl_error_handler(err, "cluEnqueue()");
 		err = clWaitForEvents(1, &event);
 		ocl_error_handler(err, "clWaitForEvents()");
-		
+		if (i >= warmup_runs)
+			wall_time += t.elapsed();
+
 		// get times for statistics
-		err = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &t_start, nullptr);
-		ocl_error_handler(err, "clGetEventProfilingInfo()");
-		err = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &t_end, nullptr);
-		ocl_error_handler(err, "clGetEventProfilingInfo()");
+		const cl_ulong t_queued = ocl_event_time(event, CL_PROFILING_COMMAND_QUEUED);
+		const cl_ulong t_start = ocl_event_time(event, CL_PROFILING_COMMAND_START);
+		const cl_ulong t_end = ocl_event_time(event, CL_PROFILING_COMMAND_END);
 		stats.add(static_cast<time::rep>(t_end - t_start));
+		stats_queued.add(static_cast<time::rep>(t_start - t_queued));
+		clReleaseEvent(event);
 	}
 
 	std::cout << name << "\t" << stats.string() << std::endl;
+	std::cout << name << "_queued_to_start\t" << stats_queued.string() << std::endl;
+	std::cout << name << "_submit\t" << stats_submit.string() << std::endl;
+	print_throughput(overall_runs - warmup_runs, num, wall_time);
+
+	if (!BACK_TO_BACK)
+		return;
+
+	// save the result of the synchronous runs, the back-to-back runs accumulate into output
+	size_t output_size = 0;
+	err = clGetMemObjectInfo(output, CL_MEM_SIZE, sizeof(size_t), &output_size, nullptr);
+	ocl_error_handler(err, "clGetMemObjectInfo(CL_MEM_SIZE)");
+	cl_mem output_saved = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_WRITE, output_size, 0, &err);
+	ocl_error_handler(err, "clCreateBuffer(output_saved)");
+	err = clEnqueueCopyBuffer(CLU_DEFAULT_Q, output, output_saved, 0, 0, output_size, 0, nullptr, nullptr);
+	ocl_error_handler(err, "clEnqueueCopyBuffer(output_saved)");
+
+	// back-to-back: the warmup runs are waited for separately, they would
+	// otherwise be part of the wall time
+	std::vector<cl_event> events(overall_runs);
+	auto enqueue_runs = [&](size_t begin, size_t end) // lambda expression
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			params.out_event = &events[i];
+			err = cluEnqueue(kernel, &params);
+			ocl_error_handler(err, "cluEnqueue()");
+		}
+	};
+	enqueue_runs(0, warmup_runs);
+	err = clFinish(CLU_DEFAULT_Q);
+	ocl_error_handler(err, "clFinish()");
+	time::timer t_wall;
+	enqueue_runs(warmup_runs, overall_runs);
+	err = clFinish(CLU_DEFAULT_Q);
+	ocl_error_handler(err, "clFinish()");
+	wall_time = t_wall.elapsed();
+
+	time::statistics stats_back_to_back(overall_runs, warmup_runs);
+	for (size_t i = 0; i < overall_runs; ++i)
+	{
+		const cl_ulong t_end = ocl_event_time(events[i], CL_PROFILING_COMMAND_END);
+		// the first measured run follows the clFinish() after the warmup
+		const cl_ulong t_prev = (i == 0 || i == warmup_runs) ? ocl_event_time(events[i], CL_PROFILING_COMMAND_START)
+		                                 : ocl_event_time(events[i - 1], CL_PROFILING_COMMAND_END);
+		stats_back_to_back.add(static_cast<time::rep>(t_end - t_prev));
+	}
+	for (cl_event e : events)
+		clReleaseEvent(e);
+
+	err = clEnqueueCopyBuffer(CLU_DEFAULT_Q, output_saved, output, 0, 0, output_size, 0, nullptr, nullptr);
+	ocl_error_handler(err, "clEnqueueCopyBuffer(output)");
+	err = clFinish(CLU_DEFAULT_Q);
+	ocl_error_handler(err, "clFinish()");
+	clReleaseMemObject(output_saved);
+
+	std::cout << name << "_back_to_back\t" << stats_back_to_back.string() << std::endl;
+	print_throughput(overall_runs - warmup_runs, num, wall_time);
 }
 
 int main(void)
@@ -86,6 +208,11 @@ int main(void)
 	print_compile_config(std::cerr);
 	std::cerr << "VEC_LENGTH_AUTO: " << VEC_LENGTH_AUTO << std::endl;
 	std::cerr << "DEVICE_TYPE: " << DEVICE_TYPE << std::endl;
+	std::cerr << "PIPELINE_CHUNKS: " << PIPELINE_CHUNKS << std::endl;
+	std::cerr << "PIPELINE_QUEUES: " << PIPELINE_QUEUES << std::endl;
+	std::cerr << "END_TO_END: " << END_TO_END << std::endl;
+	std::cerr << "BACK_TO_BACK: " << BACK_TO_BACK << std::endl;
+	std::cerr << "NUM_HAMILTONIANS: " << NUM_HAMILTONIANS << std::endl;
 
 	// constants
 	const size_t dim = DIM;
@@ -98,13 +225,14 @@ int main(void)
 
 	// allocate memory
 	size_t size_hamiltonian = dim * dim;
-	size_t size_hamiltonian_byte = sizeof(complex_t) * size_hamiltonian;
+	// NOTE: twice the size, transform_matrix_aos_to_soa_3m needs 3 * dim * dim reals
+	size_t size_hamiltonian_byte = 2 * sizeof(complex_t) * size_hamiltonian;
 	size_t size_sigma = size_hamiltonian * num;
 	size_t size_sigma_byte = sizeof(complex_t) * size_sigma;
 
-	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
-	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
-	complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma);
+	complex_t* hamiltonian = allocate_aligned<complex_t>(2 * size_hamiltonian);
+	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma, HOST_PTR_ALIGNMENT);
+	complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma, HOST_PTR_ALIGNMENT);
 	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
 	complex_t* sigma_reference_transformed = allocate_aligned<complex_t>(size_sigma);
 
@@ -112,6 +240,10 @@ int main(void)
 	initialise_hamiltonian(hamiltonian, dim);
 	initialise_sigma(sigma_in, sigma_out, dim, num);
 
+	// kernel dispatch: the real-Hamiltonian specialisations only run if H is real
+	const bool real_hamiltonian = is_real_matrix(hamiltonian, dim);
+	std::cerr << "Real Hamiltonian: " << (real_hamiltonian ? "yes" : "no") << std::endl;
+
 	// print output header
 	std::cout << "name\t" << time::statistics::header_string() << std::endl;
 	
@@ -136,7 +268,7 @@ int main(void)
 #elif (DEVICE_TYPE == CL_DEVICE_TYPE_GPU)
 	const std::string compile_options_impl = ""; // -cl-nv-verbose -cl-nv-opt-level=3 -cl-mad-enable -cl-strict-aliasing -cl-nv-arch sm_35 -cl-nv-maxrregcount=64 "; 
 #endif 
-	const std::string compile_options_common = "-Iinclude -DNUM=" STR(NUM) " -DDIM=" STR(DIM) + compile_options_impl;
+	const std::string compile_options_common = "-Iinclude -DNUM=" STR(NUM) " -DDIM=" STR(DIM) " -DNUM_JUMP_OPS=" STR(NUM_JUMP_OPS) + compile_options_impl;
 	const std::string compile_options_auto = compile_options_common + " -DVEC_LENGTH=" STR(VEC_LENGTH_AUTO) " -DPACKAGES_PER_WG=" STR(PACKAGES_PER_WG);
 	const std::string compile_options_manual = compile_options_common + " -DVEC_LENGTH=" STR(VEC_LENGTH) " -DPACKAGES_PER_WG=" STR(PACKAGES_PER_WG);
 	const std::string compile_options_gpu = compile_options_common + " -DVEC_LENGTH=2 -DCHUNK_SIZE=" STR(CHUNK_SIZE) " -DNUM_SUB_GROUPS=" STR(NUM_SUB_GROUPS);
@@ -156,6 +288,20 @@ int main(void)
 	ocl_error_handler(err, "cluGetDeviceInfo()");
 	std::cerr << "Using device: " << dev_info.device_name << std::endl;
 
+	// zero-copy capabilities of the device
+	cl_bool host_unified_memory = CL_FALSE;
+	err = clGetDeviceInfo(dev_id, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(cl_bool), &host_unified_memory, nullptr);
+	ocl_error_handler(err, "clGetDeviceInfo(CL_DEVICE_HOST_UNIFIED_MEMORY)");
+	bool svm_fine_grain = false;
+#ifdef CL_VERSION_2_0
+	cl_device_svm_capabilities svm_capabilities = 0;
+	// NOTE: fails for devices below OpenCL 2.0, i.e. no SVM
+	if (clGetDeviceInfo(dev_id, CL_DEVICE_SVM_CAPABILITIES, sizeof(svm_capabilities), &svm_capabilities, nullptr) == CL_SUCCESS)
+		svm_fine_grain = (svm_capabilities & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) != 0;
+#endif
+	std::cerr << "Host unified memory: " << (host_unified_memory ? "yes" : "no") << std::endl;
+	std::cerr << "Fine-grained SVM buffers: " << (svm_fine_grain ? "yes" : "no") << std::endl;
+
 	// allocate OpenCL device memory
 	cl_mem hamiltonian_ocl = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_ONLY, size_hamiltonian_byte, 0, &err);
 	ocl_error_handler(err, "clCreateBuffer(hamiltonian_ocl)");
@@ -164,18 +310,9 @@ int main(void)
 	cl_mem sigma_out_ocl = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_WRITE, size_sigma_byte, 0, &err);
 	ocl_error_handler(err, "clCreateBuffer(sigma_out_ocl)");
 
-	// function to build and set-up a kernel
-	auto prepare_kernel = [&](const std::string& file_name, const std::string& kernel_name, const std::string& compile_options)
+	// function to create a kernel of a built program and set its arguments
+	auto create_kernel = [&](cl_program prog, const std::string& kernel_name)
 	{
-		// build kernel
-		cl_program prog = cluBuildSourceFromFile(file_name.c_str(), compile_options.c_str(), &err);
-		if (ocl_error_handler(err, "cluBuildSourceFromFile()", false))
-		{
-			std::cerr << "OpenCL build log for: " << file_name << std::endl
-			          << cluGetBuildErrors(prog) << std::endl
-			          << "--- end of build log ---" << std::endl;
-			exit(-1);
-		}
 		cl_kernel kernel = clCreateKernel(prog, kernel_name.c_str(), &err);
 		ocl_error_handler(err, "clCreateKernel()");
 
@@ -200,8 +337,42 @@ int main(void)
 		ocl_error_handler(err, "clSetKernelArg(6)");
 
 		return kernel;
+	}; // create_kernel
+
+	// function to build and set-up a kernel
+	auto prepare_kernel = [&](const std::string& file_name, const std::string& kernel_name, const std::string& compile_options)
+	{
+		// build kernel, or load it from the program binary cache
+		cl_program prog = ocl_build_program_cached(CLU_CONTEXT, dev_id, file_name, compile_options, &err);
+		if (ocl_error_handler(err, "ocl_build_program_cached()", false))
+		{
+			if (prog) // no program, no build log, e.g. the source could not be read
+				std::cerr << "OpenCL build log for: " << file_name << std::endl
+				          << cluGetBuildErrors(prog) << std::endl
+				          << "--- end of build log ---" << std::endl;
+			exit(-1);
+		}
+		return create_kernel(prog, kernel_name);
 	}; // prepare_kernel
 
+	// function to build and set-up a kernel from source generated at runtime
+	auto prepare_kernel_source = [&](const std::string& source, const std::string& kernel_name, const std::string& compile_options)
+	{
+		const char* source_ptr = source.c_str();
+		const size_t source_size = source.size();
+		cl_program prog = clCreateProgramWithSource(CLU_CONTEXT, 1, &source_ptr, &source_size, &err);
+		ocl_error_handler(err, "clCreateProgramWithSource()");
+		err = clBuildProgram(prog, 1, &dev_id, compile_options.c_str(), nullptr, nullptr);
+		if (ocl_error_handler(err, "clBuildProgram()", false))
+		{
+			std::cerr << "OpenCL build log for: " << kernel_name << " (generated)" << std::endl
+			          << cluGetBuildErrors(prog) << std::endl
+			          << "--- end of build log ---" << std::endl;
+			exit(-1);
+		}
+		return create_kernel(prog, kernel_name);
+	}; // prepare_kernel_source
+
 	auto write_hamiltonian = [&]()
 	{
 		err = clEnqueueWriteBuffer(CLU_DEFAULT_Q, hamiltonian_ocl, CL_TRUE, 0, size_hamiltonian_byte, hamiltonian, 0, nullptr, nullptr);
@@ -229,7 +400,153 @@ int main(void)
 		std::cerr << "Deviation:\t" << deviation << std::endl;
 	}; // read_and_compare_sigma
 
-	// Lambda to: transform memory, benchmark, compare results
+	// Lambda to: benchmark a prepared kernel end-to-end, i.e. including the data
+	// movement between host and device per run, for each buffer mode:
+	//     copy: device buffers, explicit blocking writes and reads
+	//     host_ptr: CL_MEM_USE_HOST_PTR buffers wrapping sigma_in/sigma_out,
+	//               the result is made visible with map/unmap (zero-copy for
+	//               devices sharing the host memory)
+	//     svm: fine-grained SVM, host and device use the same pointers, only a
+	//          clFinish() per run (OpenCL 2.0, if supported by the device)
+	// init_sigma initialises sigma_in/sigma_out in the layout of the kernel,
+	// all other kernel arguments (hamiltonian, dipole, dissipator, ...) are
+	// inputs that stay on the device
+	auto benchmark_end_to_end = [&](cl_kernel kernel, const std::string& kernel_name, clu_nd_range range,
+	                                std::function<void()> init_sigma)
+	{
+		clu_enqueue_params params = { range, CLU_DEFAULT_Q, 0, nullptr, nullptr };
+
+		auto run = [&](const std::string& mode, std::function<void()> iteration)
+		{
+			time::statistics stats(NUM_ITERATIONS, NUM_WARMUP);
+			for (size_t i = 0; i < NUM_ITERATIONS; ++i)
+			{
+				time::timer t;
+				iteration();
+				stats.add(t);
+			}
+			std::cout << kernel_name << "_end_to_end_" << mode << "\t" << stats.string() << std::endl;
+		};
+
+		auto compare = [&](complex_t* result)
+		{
+			// compute deviation from reference	(small deviations are expected)
+			deviation = compare_matrices(result, sigma_reference_transformed, dim, num);
+			std::cerr << "Deviation:\t" << deviation << std::endl;
+		};
+
+		// copy
+		init_sigma();
+		run("copy", [&]()
+		{
+			write_sigma();
+			err = cluEnqueue(kernel, &params);
+			ocl_error_handler(err, "cluEnqueue()");
+			err = clEnqueueReadBuffer(CLU_DEFAULT_Q, sigma_out_ocl, CL_TRUE, 0, size_sigma_byte, sigma_out, 0, nullptr, nullptr);
+			ocl_error_handler(err, "clEnqueueReadBuffer(sigma_out_ocl)");
+		});
+		compare(sigma_out);
+
+		// host_ptr
+		init_sigma();
+		cl_mem sigma_in_host = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, size_sigma_byte, sigma_in, &err);
+		ocl_error_handler(err, "clCreateBuffer(sigma_in_host)");
+		cl_mem sigma_out_host = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, size_sigma_byte, sigma_out, &err);
+		ocl_error_handler(err, "clCreateBuffer(sigma_out_host)");
+		err = clSetKernelArg(kernel, 0, sizeof(cl_mem), static_cast<const void*>(&sigma_in_host));
+		ocl_error_handler(err, "clSetKernelArg(0)");
+		err = clSetKernelArg(kernel, 1, sizeof(cl_mem), static_cast<const void*>(&sigma_out_host));
+		ocl_error_handler(err, "clSetKernelArg(1)");
+		auto map_sigma_out = [&]()
+		{
+			void* mapped = clEnqueueMapBuffer(CLU_DEFAULT_Q, sigma_out_host, CL_TRUE, CL_MAP_READ, 0, size_sigma_byte, 0, nullptr, nullptr, &err);
+			ocl_error_handler(err, "clEnqueueMapBuffer(sigma_out_host)");
+			return static_cast<complex_t*>(mapped);
+		};
+		run("host_ptr", [&]()
+		{
+			err = cluEnqueue(kernel, &params);
+			ocl_error_handler(err, "cluEnqueue()");
+			complex_t* mapped = map_sigma_out();
+			err = clEnqueueUnmapMemObject(CLU_DEFAULT_Q, sigma_out_host, mapped, 0, nullptr, nullptr);
+			ocl_error_handler(err, "clEnqueueUnmapMemObject(sigma_out_host)");
+		});
+		complex_t* mapped = map_sigma_out();
+		compare(mapped);
+		err = clEnqueueUnmapMemObject(CLU_DEFAULT_Q, sigma_out_host, mapped, 0, nullptr, nullptr);
+		ocl_error_handler(err, "clEnqueueUnmapMemObject(sigma_out_host)");
+		err = clFinish(CLU_DEFAULT_Q);
+		ocl_error_handler(err, "clFinish()");
+		clReleaseMemObject(sigma_in_host);
+		clReleaseMemObject(sigma_out_host);
+
+		// svm
+#ifdef CL_VERSION_2_0
+		if (svm_fine_grain)
+		{
+			const cl_svm_mem_flags svm_flags = CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER;
+			complex_t* sigma_in_svm = static_cast<complex_t*>(clSVMAlloc(CLU_CONTEXT, svm_flags, size_sigma_byte, 0));
+			complex_t* sigma_out_svm = static_cast<complex_t*>(clSVMAlloc(CLU_CONTEXT, svm_flags, size_sigma_byte, 0));
+			if (!sigma_in_svm || !sigma_out_svm)
+				ocl_error_handler(CL_OUT_OF_HOST_MEMORY, "clSVMAlloc()");
+			init_sigma();
+			std::memcpy(sigma_in_svm, sigma_in, size_sigma_byte);
+			std::memcpy(sigma_out_svm, sigma_out, size_sigma_byte);
+			err = clSetKernelArgSVMPointer(kernel, 0, sigma_in_svm);
+			ocl_error_handler(err, "clSetKernelArgSVMPointer(0)");
+			err = clSetKernelArgSVMPointer(kernel, 1, sigma_out_svm);
+			ocl_error_handler(err, "clSetKernelArgSVMPointer(1)");
+			run("svm", [&]()
+			{
+				err = cluEnqueue(kernel, &params);
+				ocl_error_handler(err, "cluEnqueue()");
+				err = clFinish(CLU_DEFAULT_Q);
+				ocl_error_handler(err, "clFinish()");
+			});
+			compare(sigma_out_svm);
+			clSVMFree(CLU_CONTEXT, sigma_in_svm);
+			clSVMFree(CLU_CONTEXT, sigma_out_svm);
+		}
+#endif
+
+		// restore the device buffers
+		err = clSetKernelArg(kernel, 0, sizeof(cl_mem), static_cast<const void*>(&sigma_in_ocl));
+		ocl_error_handler(err, "clSetKernelArg(0)");
+		err = clSetKernelArg(kernel, 1, sizeof(cl_mem), static_cast<const void*>(&sigma_out_ocl));
+		ocl_error_handler(err, "clSetKernelArg(1)");
+	}; // benchmark_end_to_end
+
+	// Lambda to: transform memory, benchmark kernel, compare results
+	auto benchmark_prepared = [&](cl_kernel kernel, const std::string& kernel_name, size_t vec_length, clu_nd_range range,
+	                              decltype(&transform_matrices_aos_to_aosoa) transformation_sigma)
+	{
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		std::memcpy(sigma_reference_transformed, sigma_reference, size_sigma_byte);
+		// transform memory layout if a transformation is specified
+		if (transformation_sigma)
+		{
+			// transform reference for comparison
+			transformation_sigma(sigma_reference_transformed, dim, num, vec_length);
+			// tranform sigma
+			transformation_sigma(sigma_in, dim, num, vec_length);
+		}
+		write_sigma();
+
+		benchmark_ocl_kernel(kernel, kernel_name, range, num, NUM_ITERATIONS, NUM_WARMUP, sigma_out_ocl);
+		
+		read_and_compare_sigma();
+
+		if (END_TO_END)
+			benchmark_end_to_end(kernel, kernel_name, range,
+			                     [&]()
+			                     {
+			                         initialise_sigma(sigma_in, sigma_out, dim, num);
+			                         if (transformation_sigma)
+			                             transformation_sigma(sigma_in, dim, num, vec_length);
+			                     });
+	}; // benchmark_prepared
+
+	// Lambda to: build kernel, transform memory, benchmark, compare results
 	// NOTE:
 	// typedef struct
 	// {
@@ -250,23 +567,9 @@ int main(void)
 		if (transformation_hamiltonian)
 			transformation_hamiltonian(hamiltonian, dim);	
 		write_hamiltonian();
-	
-		initialise_sigma(sigma_in, sigma_out, dim, num);
-		std::memcpy(sigma_reference_transformed, sigma_reference, size_sigma_byte);
-		// transform memory layout if a transformation is specified
-		if (transformation_sigma)
-		{
-			// transform reference for comparison
-			transformation_sigma(sigma_reference_transformed, dim, num, vec_length);
-			// tranform sigma
-			transformation_sigma(sigma_in, dim, num, vec_length);
-		}
-		write_sigma();
 
 		cl_kernel kernel = prepare_kernel(file_name, kernel_name, compile_options);
-		benchmark_ocl_kernel(kernel, kernel_name, range, num, NUM_ITERATIONS, NUM_WARMUP);
-		
-		read_and_compare_sigma();
+		benchmark_prepared(kernel, kernel_name, vec_length, range, transformation_sigma);
 	}; // benchmark
 
 	// BENCHMARK: initial kernel
@@ -378,6 +681,19 @@ int main(void)
 	            { } // offset
 	          }, &transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
 
+	// BENCHMARK: real-Hamiltonian specialisation, skipped if H is not real
+	//            (commutator_ocl_aosoa_constants_direct_perm above is the general case)
+	if (real_hamiltonian)
+	{
+	benchmark("src/kernel/commutator_ocl_aosoa_constants_direct_perm_realham.cl", "commutator_ocl_aosoa_constants_direct_perm_realham",
+	          compile_options_auto, VEC_LENGTH_AUTO,
+	          { 2, // NDRange dimension
+	            { VEC_LENGTH_AUTO, num / (VEC_LENGTH_AUTO) }, // global size
+	            { (VEC_LENGTH_AUTO), PACKAGES_PER_WG }, // local size
+	            { } // offset
+	          }, &transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
+	}
+
 	// BENCHMARK: manually vectorised kernel
 	benchmark("src/kernel/commutator_ocl_manual_aosoa.cl", "commutator_ocl_manual_aosoa",
 	          compile_options_manual, VEC_LENGTH,
@@ -443,6 +759,94 @@ int main(void)
 	            { } // offset
 	          }, &transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
 	
+	// BENCHMARK: real-Hamiltonian specialisation, skipped if H is not real
+	//            (commutator_ocl_manual_aosoa_constants_direct_perm above is the general case)
+	if (real_hamiltonian)
+	{
+	benchmark("src/kernel/commutator_ocl_manual_aosoa_constants_direct_perm_realham.cl", "commutator_ocl_manual_aosoa_constants_direct_perm_realham",
+	          compile_options_manual, VEC_LENGTH,
+	          { 1, // NDRange dimension
+	            { num / VEC_LENGTH}, // global size
+	            { }, // local size
+	            { } // offset
+	          }, &transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
+	}
+	
+	// BENCHMARK: kernel generated at runtime for the Hamiltonian, fully unrolled
+	//            with its elements as literals and zero terms eliminated
+	{ // keep things local
+		initialise_hamiltonian(hamiltonian, dim);
+		transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+		const std::string kernel_name = "commutator_ocl_manual_aosoa_generated";
+		ocl_generated_source generated = ocl_generate_commutator_source(kernel_name, hamiltonian, dim);
+		std::cerr << "Generated terms:\t" << generated.num_terms << " of " << generated.num_terms_full << std::endl;
+
+		time::timer t_build;
+		cl_kernel kernel = prepare_kernel_source(generated.source, kernel_name, compile_options_manual);
+		std::cerr << "Generated kernel build time (ms):\t" << t_build.elapsed() * 1.0e-6 << std::endl;
+
+		benchmark_prepared(kernel, kernel_name, VEC_LENGTH,
+		                   { 1, // NDRange dimension
+		                     { num / VEC_LENGTH}, // global size
+		                     { }, // local size
+		                     { } // offset
+		                   }, &transform_matrices_aos_to_aosoa);
+	}
+
+	// BENCHMARK: manually vectorised kernel with compile time constants and 3M complex multiplication
+	benchmark("src/kernel/commutator_ocl_manual_aosoa_constants_3m.cl", "commutator_ocl_manual_aosoa_constants_3m",
+	          compile_options_manual, VEC_LENGTH,
+	          { 1, // NDRange dimension
+	            { num / VEC_LENGTH}, // global size
+	            { }, // local size
+	            { } // offset
+	          }, &transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa_3m);
+	
+	// BENCHMARK: manually vectorised kernel with packed Hermitian sigma, only
+	//            the upper triangle is computed, requires a Hermitian sigma and
+	//            hamiltonian, i.e. its own reference
+	{ // keep things local
+	initialise_hamiltonian_hermitian(hamiltonian, dim);
+	initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_reference(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt);
+		},
+		"commutator_reference_hermitian",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+	transform_matrices_aos_to_aosoa_hermitian(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+	transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian, dim);
+	write_hamiltonian();
+
+	initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa_hermitian(sigma_in, dim, num, VEC_LENGTH);
+	write_sigma();
+
+	const std::string kernel_name = "commutator_ocl_manual_aosoa_constants_hermitian";
+	const clu_nd_range range = { 1, // NDRange dimension
+	                             { num / VEC_LENGTH}, // global size
+	                             { }, // local size
+	                             { } // offset
+	                           };
+	cl_kernel kernel = prepare_kernel("src/kernel/" + kernel_name + ".cl", kernel_name, compile_options_manual);
+	benchmark_ocl_kernel(kernel, kernel_name, range, num, NUM_ITERATIONS, NUM_WARMUP, sigma_out_ocl);
+
+	read_and_compare_sigma();
+
+	if (END_TO_END)
+		benchmark_end_to_end(kernel, kernel_name, range,
+		                     [&]()
+		                     {
+		                         initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+		                         transform_matrices_aos_to_aosoa_hermitian(sigma_in, dim, num, VEC_LENGTH);
+		                     });
+	}
+	
 	// BENCHMARK: final GPGPU kernel, optimised for Nvidia K40
 	{ // keep things local
 	auto ceil_n = [](size_t x, size_t n) { return ((x + n - 1) / n) * n; };
@@ -458,14 +862,404 @@ int main(void)
 	          }, NO_TRANSFORM, SCALE_HAMILT, NO_TRANSFORM);
 	}
 
+	// initialisation of sigma for the end-to-end runs of the manual AoSoA kernels below
+	auto init_sigma_aosoa = [&]()
+	{
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	};
+	auto init_sigma_aosoa_hermitian = [&]()
+	{
+		initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	};
+
+	// BENCHMARK: time-dependent Hamiltonian hamiltonian + field * dipole in a
+	//            single sweep over sigma
+	{ // keep things local
+	const real_t field = 0.25; // field amplitude of this time step
+	complex_t* dipole = allocate_aligned<complex_t>(size_hamiltonian);
+	initialise_dipole(dipole, dim);
+
+	initialise_hamiltonian(hamiltonian, dim);
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_reference_field(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt, dipole, field);
+		},
+		"commutator_reference_field",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+	transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+	transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian, dim);
+	write_hamiltonian();
+	transform_matrix_scale_aos(dipole, dim, dt / hbar); // pre-scale dipole
+	transform_matrix_aos_to_soa(dipole, dim);
+	cl_mem dipole_ocl = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(complex_t) * size_hamiltonian, dipole, &err);
+	ocl_error_handler(err, "clCreateBuffer(dipole_ocl)");
+
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	write_sigma();
+
+	cl_kernel kernel = prepare_kernel("src/kernel/commutator_ocl_manual_aosoa_constants_direct_perm_field.cl",
+	                                  "commutator_ocl_manual_aosoa_constants_direct_perm_field", compile_options_manual);
+	err = clSetKernelArg(kernel, 7, sizeof(cl_mem), static_cast<const void*>(&dipole_ocl));
+	ocl_error_handler(err, "clSetKernelArg(7)");
+	// NOTE: the field amplitude is a by-value argument, i.e. it is updated per
+	//       time step by clSetKernelArg() without any buffer transfer
+	err = clSetKernelArg(kernel, 8, sizeof(real_t), static_cast<const void*>(&field));
+	ocl_error_handler(err, "clSetKernelArg(8)");
+	const clu_nd_range range = { 1, // NDRange dimension
+	                             { num / VEC_LENGTH}, // global size
+	                             { }, // local size
+	                             { } // offset
+	                           };
+	benchmark_ocl_kernel(kernel, "commutator_ocl_manual_aosoa_constants_direct_perm_field", range,
+	                     num, NUM_ITERATIONS, NUM_WARMUP, sigma_out_ocl);
+
+	read_and_compare_sigma();
+
+	if (END_TO_END)
+		benchmark_end_to_end(kernel, "commutator_ocl_manual_aosoa_constants_direct_perm_field", range, init_sigma_aosoa);
+
+	clReleaseMemObject(dipole_ocl);
+	free(dipole);
+	}
+
+	// BENCHMARK: one hamiltonian per package, and a table of NUM_HAMILTONIANS
+	//            hamiltonians indexed per package, see benchmark_batched_omp
+	{ // keep things local
+	const size_t num_packages = num / VEC_LENGTH;
+	const size_t num_hamiltonians = NUM_HAMILTONIANS;
+	complex_t* hamiltonians = allocate_aligned<complex_t>(size_sigma); // one per sigma, for the reference
+	complex_t* hamiltonian_packages = allocate_aligned<complex_t>(size_hamiltonian * std::max(num_packages, num_hamiltonians));
+	int* hamiltonian_index = allocate_aligned<int>(num_packages);
+	cl_mem hamiltonians_ocl = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_ONLY, sizeof(complex_t) * size_hamiltonian * std::max(num_packages, num_hamiltonians), 0, &err);
+	ocl_error_handler(err, "clCreateBuffer(hamiltonians_ocl)");
+	cl_mem hamiltonian_index_ocl = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_ONLY, sizeof(int) * num_packages, 0, &err);
+	ocl_error_handler(err, "clCreateBuffer(hamiltonian_index_ocl)");
+
+	// Lambda to: compute the reference, benchmark, compare results, the
+	// hamiltonians of the packages are pre-scaled, SoA and in hamiltonians_ocl
+	auto benchmark_batched = [&](const std::string& kernel_name, std::function<void(cl_kernel)> set_arguments)
+	{
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_reference_batched(sigma_in, sigma_out, hamiltonians, dim, num, hbar, dt);
+			},
+			"commutator_reference_batched",
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+		std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+		transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+		write_sigma();
+
+		cl_kernel kernel = prepare_kernel("src/kernel/" + kernel_name + ".cl", kernel_name, compile_options_manual);
+		err = clSetKernelArg(kernel, 2, sizeof(cl_mem), static_cast<const void*>(&hamiltonians_ocl));
+		ocl_error_handler(err, "clSetKernelArg(2)");
+		set_arguments(kernel);
+		const clu_nd_range range = { 1, // NDRange dimension
+		                             { num / VEC_LENGTH}, // global size
+		                             { }, // local size
+		                             { } // offset
+		                           };
+		benchmark_ocl_kernel(kernel, kernel_name, range, num, NUM_ITERATIONS, NUM_WARMUP, sigma_out_ocl);
+
+		read_and_compare_sigma();
+
+		if (END_TO_END)
+			benchmark_end_to_end(kernel, kernel_name, range, init_sigma_aosoa);
+	};
+
+	// Lambda to: expand the hamiltonian of each package for the reference,
+	// pre-scale and transform the used ones, upload them
+	auto prepare_hamiltonians = [&](size_t num_used, std::function<size_t(size_t)> package_hamiltonian)
+	{
+		for (size_t p = 0; p < num_packages; ++p)
+			for (size_t v = 0; v < VEC_LENGTH; ++v)
+				std::memcpy(hamiltonians + (p * VEC_LENGTH + v) * size_hamiltonian,
+				            hamiltonian_packages + package_hamiltonian(p) * size_hamiltonian,
+				            sizeof(complex_t) * size_hamiltonian);
+		for (size_t h = 0; h < num_used; ++h)
+		{
+			transform_matrix_scale_aos(hamiltonian_packages + h * size_hamiltonian, dim, dt / hbar);
+			transform_matrix_aos_to_soa(hamiltonian_packages + h * size_hamiltonian, dim);
+		}
+		err = clEnqueueWriteBuffer(CLU_DEFAULT_Q, hamiltonians_ocl, CL_TRUE, 0, sizeof(complex_t) * size_hamiltonian * num_used, hamiltonian_packages, 0, nullptr, nullptr);
+		ocl_error_handler(err, "clEnqueueWriteBuffer(hamiltonians_ocl)");
+	};
+
+	// one hamiltonian per package
+	initialise_hamiltonians(hamiltonian_packages, dim, num_packages);
+	prepare_hamiltonians(num_packages, [](size_t p) { return p; });
+	benchmark_batched("commutator_ocl_manual_aosoa_constants_direct_perm_batched", [](cl_kernel) {});
+
+	// table of hamiltonians, one index per package
+	initialise_hamiltonians(hamiltonian_packages, dim, num_hamiltonians);
+	for (size_t p = 0; p < num_packages; ++p)
+		hamiltonian_index[p] = (p * 7) % num_hamiltonians;
+	prepare_hamiltonians(num_hamiltonians, [&](size_t p) { return static_cast<size_t>(hamiltonian_index[p]); });
+	err = clEnqueueWriteBuffer(CLU_DEFAULT_Q, hamiltonian_index_ocl, CL_TRUE, 0, sizeof(int) * num_packages, hamiltonian_index, 0, nullptr, nullptr);
+	ocl_error_handler(err, "clEnqueueWriteBuffer(hamiltonian_index_ocl)");
+	benchmark_batched("commutator_ocl_manual_aosoa_constants_direct_perm_indexed",
+	                  [&](cl_kernel kernel)
+	                  {
+	                      err = clSetKernelArg(kernel, 7, sizeof(cl_mem), static_cast<const void*>(&hamiltonian_index_ocl));
+	                      ocl_error_handler(err, "clSetKernelArg(7)");
+	                  });
+
+	clReleaseMemObject(hamiltonians_ocl);
+	clReleaseMemObject(hamiltonian_index_ocl);
+	free(hamiltonians);
+	free(hamiltonian_packages);
+	free(hamiltonian_index);
+	}
+
+	// BENCHMARK: Lindblad equation with NUM_JUMP_OPS jump operators, dissipator
+	//            fused with the commutator (general and pure dephasing case)
+	{ // keep things local
+	complex_t* jump_operators = allocate_aligned<complex_t>(NUM_JUMP_OPS * size_hamiltonian);
+	complex_t* jump_operators_scaled = allocate_aligned<complex_t>(NUM_JUMP_OPS * size_hamiltonian);
+	real_t* dephasing = allocate_aligned<real_t>(size_hamiltonian);
+	cl_mem dissipator_ocl = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_ONLY, sizeof(complex_t) * NUM_JUMP_OPS * size_hamiltonian, 0, &err);
+	ocl_error_handler(err, "clCreateBuffer(dissipator_ocl)");
+
+	// Lambda to: compute the reference, benchmark, compare results
+	auto benchmark_lindblad = [&](const std::string& kernel_name,
+	                              std::function<void()> transformation_hamiltonian,
+	                              void const* dissipator, size_t dissipator_byte,
+	                              const std::string& reference_name)
+	{
+		initialise_hamiltonian_hermitian(hamiltonian, dim); // the kernels compute sigma * H^H
+		initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_reference_lindblad(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt, jump_operators, NUM_JUMP_OPS);
+			},
+			reference_name,
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+		std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+		transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+		transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+		transformation_hamiltonian();
+		write_hamiltonian();
+		err = clEnqueueWriteBuffer(CLU_DEFAULT_Q, dissipator_ocl, CL_TRUE, 0, dissipator_byte, dissipator, 0, nullptr, nullptr);
+		ocl_error_handler(err, "clEnqueueWriteBuffer(dissipator_ocl)");
+
+		initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+		write_sigma();
+
+		cl_kernel kernel = prepare_kernel("src/kernel/" + kernel_name + ".cl", kernel_name, compile_options_manual);
+		err = clSetKernelArg(kernel, 7, sizeof(cl_mem), static_cast<const void*>(&dissipator_ocl));
+		ocl_error_handler(err, "clSetKernelArg(7)");
+		const clu_nd_range range = { 1, // NDRange dimension
+		                             { num / VEC_LENGTH}, // global size
+		                             { }, // local size
+		                             { } // offset
+		                           };
+		benchmark_ocl_kernel(kernel, kernel_name, range, num, NUM_ITERATIONS, NUM_WARMUP, sigma_out_ocl);
+
+		read_and_compare_sigma();
+
+		if (END_TO_END)
+			benchmark_end_to_end(kernel, kernel_name, range, init_sigma_aosoa_hermitian);
+	};
+
+	// general jump operators
+	initialise_jump_operators(jump_operators, dim, NUM_JUMP_OPS);
+	std::memcpy(jump_operators_scaled, jump_operators, sizeof(complex_t) * NUM_JUMP_OPS * size_hamiltonian);
+	for (size_t l = 0; l < NUM_JUMP_OPS; ++l)
+	{
+		transform_matrix_scale_aos(jump_operators_scaled + l * size_hamiltonian, dim, std::sqrt(dt)); // pre-scale
+		transform_matrix_aos_to_soa(jump_operators_scaled + l * size_hamiltonian, dim);
+	}
+	benchmark_lindblad("commutator_ocl_manual_aosoa_constants_lindblad",
+	                   [&]() { transform_matrix_aos_to_soa_lindblad(hamiltonian, jump_operators, NUM_JUMP_OPS, dim, dt); },
+	                   jump_operators_scaled, sizeof(complex_t) * NUM_JUMP_OPS * size_hamiltonian,
+	                   "commutator_reference_lindblad");
+
+	// pure dephasing
+	initialise_dephasing_operators(jump_operators, dim, NUM_JUMP_OPS);
+	dephasing_rates(jump_operators, NUM_JUMP_OPS, dim, dt, dephasing);
+	benchmark_lindblad("commutator_ocl_manual_aosoa_constants_dephasing",
+	                   [&]() { transform_matrix_aos_to_soa(hamiltonian, dim); },
+	                   dephasing, sizeof(real_t) * size_hamiltonian,
+	                   "commutator_reference_dephasing");
+
+	clReleaseMemObject(dissipator_ocl);
+	free(jump_operators);
+	free(jump_operators_scaled);
+	free(dephasing);
+	}
+
+
+	// BENCHMARK: end-to-end, i.e. upload, kernel and download of sigma per run,
+	//            sigma streams through the device in package-aligned chunks,
+	//            chunk c is processed on in-order queue c % num_queues, i.e.
+	//            the transfers of one queue overlap the kernel of the other
+	// NOTE: each queue has its own pair of chunk-sized device buffers, reused
+	//       for every num_queues-th chunk once the download of the previous
+	//       one has completed, i.e. the device memory scales with the chunk
+	//       size, not with NUM
+	{ // keep things local
+	cl_command_queue queues[PIPELINE_QUEUES];
+	queues[0] = CLU_DEFAULT_Q;
+	for (int q = 1; q < PIPELINE_QUEUES; ++q)
+	{
+		queues[q] = clCreateCommandQueue(CLU_CONTEXT, dev_id, CL_QUEUE_PROFILING_ENABLE, &err);
+		ocl_error_handler(err, "clCreateCommandQueue()");
+	}
+
+	// Lambda to: benchmark end-to-end with num_chunks chunks on num_queues queues
+	auto benchmark_pipelined = [&](cl_kernel kernel, const std::string& name, size_t num_chunks, int num_queues)
+	{
+		const size_t num_packages = num / VEC_LENGTH;
+		const size_t chunk_packages = (num_packages + num_chunks - 1) / num_chunks;
+		const size_t package_byte = VEC_LENGTH * size_hamiltonian * sizeof(complex_t);
+		std::vector<cl_event> last_events(num_queues);
+
+		// one pair of chunk buffers per queue
+		std::vector<cl_mem> chunk_in(num_queues);
+		std::vector<cl_mem> chunk_out(num_queues);
+		for (int q = 0; q < num_queues; ++q)
+		{
+			chunk_in[q] = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_WRITE, chunk_packages * package_byte, 0, &err);
+			ocl_error_handler(err, "clCreateBuffer(chunk_in)");
+			chunk_out[q] = clCreateBuffer(CLU_CONTEXT, CL_MEM_READ_WRITE, chunk_packages * package_byte, 0, &err);
+			ocl_error_handler(err, "clCreateBuffer(chunk_out)");
+		}
+		std::cerr << "Device memory for sigma (bytes):\t" << 2 * num_queues * chunk_packages * package_byte << std::endl;
+
+		time::statistics stats(NUM_ITERATIONS, NUM_WARMUP);
+		for (size_t i = 0; i < NUM_ITERATIONS; ++i)
+		{
+			time::timer t;
+			for (int q = 0; q < num_queues; ++q)
+				last_events[q] = nullptr;
+			for (size_t c = 0; c < num_chunks && c * chunk_packages < num_packages; ++c)
+			{
+				const size_t first = c * chunk_packages;
+				const size_t count = std::min(chunk_packages, num_packages - first);
+				const int q = c % num_queues;
+
+				// sigma_out is accumulated into, i.e. it is uploaded as well,
+				// the buffers of queue q are reused after the previous download
+				const cl_uint num_wait = last_events[q] ? 1 : 0;
+				err = clEnqueueWriteBuffer(queues[q], chunk_in[q], CL_FALSE, 0, count * package_byte,
+				                           reinterpret_cast<char*>(sigma_in) + first * package_byte,
+				                           num_wait, num_wait ? &last_events[q] : nullptr, nullptr);
+				ocl_error_handler(err, "clEnqueueWriteBuffer(chunk_in)");
+				err = clEnqueueWriteBuffer(queues[q], chunk_out[q], CL_FALSE, 0, count * package_byte,
+				                           reinterpret_cast<char*>(sigma_out) + first * package_byte,
+				                           num_wait, num_wait ? &last_events[q] : nullptr, nullptr);
+				ocl_error_handler(err, "clEnqueueWriteBuffer(chunk_out)");
+				if (last_events[q])
+					clReleaseEvent(last_events[q]);
+
+				// the arguments are captured at enqueue time
+				err = clSetKernelArg(kernel, 0, sizeof(cl_mem), static_cast<const void*>(&chunk_in[q]));
+				ocl_error_handler(err, "clSetKernelArg(0)");
+				err = clSetKernelArg(kernel, 1, sizeof(cl_mem), static_cast<const void*>(&chunk_out[q]));
+				ocl_error_handler(err, "clSetKernelArg(1)");
+				clu_enqueue_params params = { { 1, // NDRange dimension
+				                                { count }, // global size
+				                                { }, // local size
+				                                { } // offset
+				                              }, queues[q], 0, nullptr, nullptr };
+				err = cluEnqueue(kernel, &params);
+				ocl_error_handler(err, "cluEnqueue()");
+				err = clEnqueueReadBuffer(queues[q], chunk_out[q], CL_FALSE, 0, count * package_byte,
+				                          reinterpret_cast<char*>(sigma_out) + first * package_byte, 0, nullptr, &last_events[q]);
+				ocl_error_handler(err, "clEnqueueReadBuffer(chunk_out)");
+			}
+			for (int q = 0; q < num_queues; ++q)
+			{
+				err = clFlush(queues[q]);
+				ocl_error_handler(err, "clFlush()");
+			}
+			for (int q = 0; q < num_queues; ++q)
+			{
+				if (!last_events[q])
+					continue;
+				err = clWaitForEvents(1, &last_events[q]);
+				ocl_error_handler(err, "clWaitForEvents()");
+				clReleaseEvent(last_events[q]);
+			}
+			stats.add(t);
+		}
+		std::cout << name << "\t" << stats.string() << std::endl;
+
+		for (int q = 0; q < num_queues; ++q)
+		{
+			clReleaseMemObject(chunk_in[q]);
+			clReleaseMemObject(chunk_out[q]);
+		}
+		// restore the full-size buffers
+		err = clSetKernelArg(kernel, 0, sizeof(cl_mem), static_cast<const void*>(&sigma_in_ocl));
+		ocl_error_handler(err, "clSetKernelArg(0)");
+		err = clSetKernelArg(kernel, 1, sizeof(cl_mem), static_cast<const void*>(&sigma_out_ocl));
+		ocl_error_handler(err, "clSetKernelArg(1)");
+
+		// average runtime is in ns, sigma_in and sigma_out up, sigma_out down
+		std::cerr << "End-to-end throughput (matrices/s):\t" << num / (stats.average() * 1.0e-9) << std::endl;
+		std::cerr << "End-to-end transfer rate (GB/s):\t" << 3.0 * size_sigma_byte / stats.average() << std::endl;
+
+		// compute deviation from reference	(small deviations are expected)
+		deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+		std::cerr << "Deviation:\t" << deviation << std::endl;
+	};
+
+	const std::string kernel_name = "commutator_ocl_manual_aosoa_constants_direct_perm";
+	initialise_hamiltonian(hamiltonian, dim);
+	transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian, dim);
+	write_hamiltonian();
+	cl_kernel kernel = prepare_kernel("src/kernel/" + kernel_name + ".cl", kernel_name, compile_options_manual);
+	std::memcpy(sigma_reference_transformed, sigma_reference, size_sigma_byte);
+	transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+	// whole arrays, one queue, i.e. no overlap
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	benchmark_pipelined(kernel, kernel_name + "_end_to_end", 1, 1);
+
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	benchmark_pipelined(kernel, kernel_name + "_pipelined", PIPELINE_CHUNKS, PIPELINE_QUEUES);
+
+	for (int q = 1; q < PIPELINE_QUEUES; ++q)
+		clReleaseCommandQueue(queues[q]);
+	}
+
+	// startup cost of the kernel builds: a cold run (empty cache) builds all
+	// programs from source, a warm run only loads their binaries
+	ocl_program_cache_statistics const& cache_stats = ocl_program_cache_stats();
+	std::cerr << "Program cache hits/misses:\t" << cache_stats.hits << "\t" << cache_stats.misses << std::endl;
+	std::cerr << "Program build time from source (ms, cold):\t" << cache_stats.build_ms << std::endl;
+	std::cerr << "Program build time from binary (ms, warm):\t" << cache_stats.load_ms << std::endl;
 
 	// de-init CLU
 	cluRelease(); 
 
-	delete hamiltonian;
-	delete sigma_in;
-	delete sigma_out;
-	delete sigma_reference;
+	free(hamiltonian);
+	free(sigma_in);
+	free(sigma_out);
+	free(sigma_reference);
+	free(sigma_reference_transformed);
 
 	return 0;
 }
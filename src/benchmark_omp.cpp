@@ -11,6 +11,7 @@
 #include "ham/util/time.hpp" // ham::util::time
 
 #include "common.hpp"
+#include "memory.hpp"
 #include "kernel/kernel.hpp"
 
 using namespace ham::util;
@@ -32,16 +33,25 @@ int main(void)
 	size_t size_sigma = size_hamiltonian * num;
 	size_t size_sigma_byte = sizeof(complex_t) * size_sigma;
 
-	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
-	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
-	complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma);
-	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
-	complex_t* sigma_reference_transformed = allocate_aligned<complex_t>(size_sigma);
+	// NOTE: twice the size, transform_matrix_aos_to_soa_3m needs 3 * dim * dim reals
+	complex_t* hamiltonian = allocate_aligned<complex_t>(2 * size_hamiltonian);
+	// sigma arrays with the page size selected by HEXCITON_PAGES (4k, thp, 2m, 1g)
+	const page_size_kind pages = page_size_from_env();
+	size_t page_bytes = 0;
+	complex_t* sigma_in = allocate_huge<complex_t>(size_sigma, pages, &page_bytes);
+	std::cerr << "Pages: requested " << page_size_name(pages) << ", obtained " << page_bytes / 1024 << " KiB" << std::endl;
+	complex_t* sigma_out = allocate_huge<complex_t>(size_sigma, pages);
+	complex_t* sigma_reference = allocate_huge<complex_t>(size_sigma, pages);
+	complex_t* sigma_reference_transformed = allocate_huge<complex_t>(size_sigma, pages);
 
 	// initialise memory
 	initialise_hamiltonian(hamiltonian, dim);
 	initialise_sigma(sigma_in, sigma_out, dim, num);
 
+	// kernel dispatch: the real-Hamiltonian specialisations only run if H is real
+	const bool real_hamiltonian = is_real_matrix(hamiltonian, dim);
+	std::cerr << "Real Hamiltonian: " << (real_hamiltonian ? "yes" : "no") << std::endl;
+
 	// print output header
 	std::cout << "name\t" << time::statistics::header_string() << std::endl;
 	
@@ -157,6 +167,19 @@ int main(void)
 		},
 		"commutator_omp_aosoa_constants_direct_perm2to5",
 		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);		
+
+	// BENCHMARK: real-Hamiltonian specialisation, skipped if H is not real
+	//            (commutator_omp_aosoa_constants_direct_perm above is the general case)
+	if (real_hamiltonian)
+	{
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_aosoa_constants_direct_perm_realham( SCALAR_ARGUMENTS );
+		},
+		"commutator_omp_aosoa_constants_direct_perm_realham",
+		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
+	}
 		
 
 	// manually vectorised kernels
@@ -236,13 +259,316 @@ int main(void)
 		},
 		"commutator_omp_manual_aosoa_constants_direct_perm_unrollhints",
 		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);		
+
+	// BENCHMARK: real-Hamiltonian specialisation, skipped if H is not real
+	//            (commutator_omp_manual_aosoa_constants_direct_perm above is the general case)
+	if (real_hamiltonian)
+	{
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm_realham( VECTOR_ARGUMENTS );
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm_realham",
+		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
+	}
+
+	// BENCHMARK: 3M complex multiplication, 6 instead of 8 multiplications per k
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_3m( VECTOR_ARGUMENTS );
+		},
+		"commutator_omp_manual_aosoa_constants_3m",
+		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa_3m);
+
+	// BENCHMARK: fully unrolled template instance, selected by the runtime dim
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_template( VECTOR_ARGUMENTS );
+		},
+		"commutator_omp_manual_aosoa_template",
+		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
+
+#ifdef HOST_AVX512
+	// BENCHMARK: AVX-512 intrinsics, FMA with broadcast Hamiltonian elements
+	benchmark(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm_avx512( VECTOR_ARGUMENTS );
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm_avx512",
+		&transform_matrices_aos_to_aosoa, SCALE_HAMILT, &transform_matrix_aos_to_soa);
+#endif
+
+	// BENCHMARK: kernels that require a Hermitian sigma and hamiltonian, i.e.
+	//            their own reference
+	{ // keep things local
+	initialise_hamiltonian_hermitian(hamiltonian, dim);
+	initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_reference(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt);
+		},
+		"commutator_reference_hermitian",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+	transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+	transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+
+	// propagation in the eigenbasis of the hamiltonian, the commutator becomes
+	// an element-wise scaling, sigma is transformed once before and the result
+	// once after all iterations
+	real_t* eigenvalues = allocate_aligned<real_t>(dim);
+	complex_t* basis = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* basis_inverse = allocate_aligned<complex_t>(size_hamiltonian);
+
+	diagonalise_hermitian(hamiltonian, dim, eigenvalues, basis);
+	std::memcpy(basis_inverse, basis, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_conjugate_transpose(basis_inverse, dim); // unitary
+	transform_matrix_aos_to_soa(basis, dim);
+	transform_matrix_aos_to_soa(basis_inverse, dim);
+
+	initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			basis_transform_omp_manual_aosoa_constants(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                           reinterpret_cast<real_t*>(basis), num, dim);
+		},
+		"basis_transform_omp_manual_aosoa_constants_forward", 1, 0); // once: into the eigenbasis
+
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_eigenbasis(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                                 reinterpret_cast<real_vec_t*>(sigma_out),
+			                                                 eigenvalues, num, dim, 0.0, 0.0);
+		},
+		"commutator_omp_manual_aosoa_constants_eigenbasis", NUM_ITERATIONS, NUM_WARMUP);
+
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			basis_transform_omp_manual_aosoa_constants(reinterpret_cast<real_vec_t*>(sigma_out),
+			                                           reinterpret_cast<real_t*>(basis_inverse), num, dim);
+		},
+		"basis_transform_omp_manual_aosoa_constants_backward", 1, 0); // once: back for reading the results
+
+	// compute deviation from reference	(small deviations are expected)
+	deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+	std::cerr << "Deviation:\t" << deviation << std::endl;
+
+	free(eigenvalues);
+	free(basis);
+	free(basis_inverse);
+
+	// packed Hermitian sigma, only the upper triangle is computed
+	transform_matrices_aosoa_to_aos(sigma_reference_transformed, dim, num, VEC_LENGTH);
+	transform_matrices_aos_to_aosoa_hermitian(sigma_reference_transformed, dim, num, VEC_LENGTH);
+	transform_matrix_aos_to_soa(hamiltonian, dim);
+	initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa_hermitian(sigma_in, dim, num, VEC_LENGTH);
+
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_hermitian( VECTOR_ARGUMENTS );
+		},
+		"commutator_omp_manual_aosoa_constants_hermitian", NUM_ITERATIONS, NUM_WARMUP);
+
+	// compute deviation from reference	(small deviations are expected)
+	deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+	std::cerr << "Deviation:\t" << deviation << std::endl;
+	}
+
+	// BENCHMARK: time-dependent Hamiltonian hamiltonian + field * dipole, one
+	//            sweep over sigma vs. two commutator sweeps (hamiltonian,
+	//            field * dipole) as baseline
+	{ // keep things local
+	const real_t field = 0.25; // field amplitude of this time step
+	complex_t* dipole = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* dipole_field = allocate_aligned<complex_t>(size_hamiltonian);
+
+	initialise_hamiltonian(hamiltonian, dim);
+	initialise_dipole(dipole, dim);
+
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_reference_field(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt, dipole, field);
+		},
+		"commutator_reference_field",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+	transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+	transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian, dim);
+	transform_matrix_scale_aos(dipole, dim, dt / hbar); // pre-scale dipole
+	std::memcpy(dipole_field, dipole, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_scale_aos(dipole_field, dim, field);
+	transform_matrix_aos_to_soa(dipole, dim);
+	transform_matrix_aos_to_soa(dipole_field, dim);
+
+	// two sweeps
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                                  reinterpret_cast<real_vec_t*>(sigma_out),
+			                                                  reinterpret_cast<real_t*>(hamiltonian), num, dim, 0.0, 0.0);
+			commutator_omp_manual_aosoa_constants_direct_perm(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                                  reinterpret_cast<real_vec_t*>(sigma_out),
+			                                                  reinterpret_cast<real_t*>(dipole_field), num, dim, 0.0, 0.0);
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm_two_sweeps", NUM_ITERATIONS, NUM_WARMUP);
+	deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+	std::cerr << "Deviation:\t" << deviation << std::endl;
+
+	// single sweep
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_direct_perm_field(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                                        reinterpret_cast<real_vec_t*>(sigma_out),
+			                                                        reinterpret_cast<real_t*>(hamiltonian), num, dim, 0.0, 0.0,
+			                                                        reinterpret_cast<real_t*>(dipole), field);
+		},
+		"commutator_omp_manual_aosoa_constants_direct_perm_field", NUM_ITERATIONS, NUM_WARMUP);
+	deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+	std::cerr << "Deviation:\t" << deviation << std::endl;
+
+	free(dipole);
+	free(dipole_field);
+	}
+
+	// BENCHMARK: Lindblad equation with NUM_JUMP_OPS jump operators, dissipator
+	//            fused with the commutator (general and pure dephasing case)
+	{ // keep things local
+	complex_t* jump_operators = allocate_aligned<complex_t>(NUM_JUMP_OPS * size_hamiltonian);
+	complex_t* jump_operators_scaled = allocate_aligned<complex_t>(NUM_JUMP_OPS * size_hamiltonian);
+	real_t* dephasing = allocate_aligned<real_t>(size_hamiltonian);
+
+	// Lambda to: compute the reference, benchmark, compare results
+	auto benchmark_lindblad = [&](std::function<void()> kernel, std::string name,
+	                              std::function<void()> transformation_hamiltonian,
+	                              const std::string& reference_name)
+	{
+		initialise_hamiltonian_hermitian(hamiltonian, dim); // the kernels compute sigma * H^H
+		initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_reference_lindblad(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt, jump_operators, NUM_JUMP_OPS);
+			},
+			reference_name,
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+		std::memcpy(sigma_reference_transformed, sigma_out, size_sigma_byte);
+		transform_matrices_aos_to_aosoa(sigma_reference_transformed, dim, num, VEC_LENGTH);
+
+		transform_matrix_scale_aos(hamiltonian, dim, dt / hbar); // pre-scale hamiltonian
+		transformation_hamiltonian();
+		initialise_sigma_hermitian(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+
+		benchmark_kernel(kernel, name, NUM_ITERATIONS, NUM_WARMUP);
+
+		// compute deviation from reference	(small deviations are expected)
+		deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+		std::cerr << "Deviation:\t" << deviation << std::endl;
+	};
+
+	// general jump operators
+	initialise_jump_operators(jump_operators, dim, NUM_JUMP_OPS);
+	std::memcpy(jump_operators_scaled, jump_operators, sizeof(complex_t) * NUM_JUMP_OPS * size_hamiltonian);
+	for (size_t l = 0; l < NUM_JUMP_OPS; ++l)
+	{
+		transform_matrix_scale_aos(jump_operators_scaled + l * size_hamiltonian, dim, std::sqrt(dt)); // pre-scale
+		transform_matrix_aos_to_soa(jump_operators_scaled + l * size_hamiltonian, dim);
+	}
+	benchmark_lindblad(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_lindblad(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                               reinterpret_cast<real_vec_t*>(sigma_out),
+			                                               reinterpret_cast<real_t*>(hamiltonian), num, dim, 0.0, 0.0,
+			                                               reinterpret_cast<real_t*>(jump_operators_scaled));
+		},
+		"commutator_omp_manual_aosoa_constants_lindblad",
+		[&]() { transform_matrix_aos_to_soa_lindblad(hamiltonian, jump_operators, NUM_JUMP_OPS, dim, dt); },
+		"commutator_reference_lindblad");
+
+	// pure dephasing
+	initialise_dephasing_operators(jump_operators, dim, NUM_JUMP_OPS);
+	dephasing_rates(jump_operators, NUM_JUMP_OPS, dim, dt, dephasing);
+	benchmark_lindblad(
+		[&]() // lambda expression
+		{
+			commutator_omp_manual_aosoa_constants_dephasing(reinterpret_cast<real_vec_t*>(sigma_in),
+			                                                reinterpret_cast<real_vec_t*>(sigma_out),
+			                                                reinterpret_cast<real_t*>(hamiltonian), num, dim, 0.0, 0.0,
+			                                                dephasing);
+		},
+		"commutator_omp_manual_aosoa_constants_dephasing",
+		[&]() { transform_matrix_aos_to_soa(hamiltonian, dim); },
+		"commutator_reference_dephasing");
+
+	free(jump_operators);
+	free(jump_operators_scaled);
+	free(dephasing);
+	}
+
+	// BENCHMARK: in-place layout transforms AoS -> AoSoA -> AoS, the result
+	//            has to be identical to the input
+	{ // keep things local
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+	std::memcpy(sigma_out, sigma_in, size_sigma_byte);
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+			transform_matrices_aosoa_to_aos(sigma_in, dim, num, VEC_LENGTH);
+		},
+		"transform_matrices_aos_to_aosoa_to_aos",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	deviation = compare_matrices(sigma_in, sigma_out, dim, num);
+	std::cerr << "Deviation:\t" << deviation << std::endl;
+
+	benchmark_kernel(
+		[&]() // lambda expression
+		{
+			transform_matrices_aos_to_aosoa_gpu(sigma_in, dim, num, VEC_LENGTH);
+			transform_matrices_aosoa_gpu_to_aos(sigma_in, dim, num, VEC_LENGTH);
+		},
+		"transform_matrices_aos_to_aosoa_gpu_to_aos",
+		NUM_ITERATIONS,
+		NUM_WARMUP);
+	deviation = compare_matrices(sigma_in, sigma_out, dim, num);
+	std::cerr << "Deviation:\t" << deviation << std::endl;
+	}
 		
 
 
-	delete hamiltonian;
-	delete sigma_in;
-	delete sigma_out;
-	delete sigma_reference;
+	free(hamiltonian);
+	free_huge(sigma_in);
+	free_huge(sigma_out);
+	free_huge(sigma_reference);
+	free_huge(sigma_reference_transformed);
 
 	return 0;
 }
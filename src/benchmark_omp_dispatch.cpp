@@ -0,0 +1,146 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// benchmark_omp with runtime ISA dispatch, see make_omp.sh -m
+// NOTE: VEC_LENGTH is the one of the baseline ISA level here, the kernels use
+//       the vec_length of the selected table
+
+#include <iostream>
+
+#include <cstring> // memcpy
+#include <cmath>
+
+#include "ham/util/time.hpp" // ham::util::time
+
+#include "common.hpp"
+#include "kernel/kernel.hpp"
+#include "kernel/kernel_table.hpp"
+
+using namespace ham::util;
+
+int main(void)
+{
+	print_compile_config(std::cerr);
+
+	kernel_table const* table = select_kernel_table();
+	if (!table)
+		return 1;
+	std::cerr << "ISA: " << table->isa << std::endl;
+	std::cerr << "ISA VEC_LENGTH: " << table->vec_length << std::endl;
+
+	// constants
+	const size_t dim = DIM;
+	const size_t num = NUM;
+	const size_t vec_length = table->vec_length;
+	const real_t hbar = 1.0 / std::acos(-1.0); // == 1 / Pi
+	const real_t dt = 1.0e-3;
+
+	if (num % vec_length != 0)
+	{
+		std::cerr << "Error: NUM must be a multiple of " << vec_length << std::endl;
+		return 1;
+	}
+
+	real_t deviation = 0.0;
+
+	// allocate memory
+	size_t size_hamiltonian = dim * dim;
+	size_t size_sigma = size_hamiltonian * num;
+	size_t size_sigma_byte = sizeof(complex_t) * size_sigma;
+
+	// NOTE: twice the size, transform_matrix_aos_to_soa_3m needs 3 * dim * dim reals
+	complex_t* hamiltonian = allocate_aligned<complex_t>(2 * size_hamiltonian);
+	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_reference_transformed = allocate_aligned<complex_t>(size_sigma);
+
+	// initialise memory
+	initialise_hamiltonian(hamiltonian, dim);
+	initialise_sigma(sigma_in, sigma_out, dim, num);
+
+	const bool real_hamiltonian = is_real_matrix(hamiltonian, dim);
+	std::cerr << "Real Hamiltonian: " << (real_hamiltonian ? "yes" : "no") << std::endl;
+
+	// print output header
+	std::cout << "name\t" << time::statistics::header_string() << std::endl;
+
+	// Lambda to: compute the reference for the current inputs
+	auto compute_reference = [&](std::string name)
+	{
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_reference(sigma_in, sigma_out, hamiltonian, dim, num, hbar, dt);
+			},
+			name,
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+
+		// copy reference results
+		std::memcpy(sigma_reference, sigma_out, size_sigma_byte);
+	};
+
+	// perform reference computation for correctness analysis
+	compute_reference("commutator_reference");
+
+	// first all kernels for the general inputs, then the ones that require
+	// Hermitian inputs with their own reference
+	for (bool hermitian : { false, true })
+	{
+		auto init_hamiltonian = hermitian ? &initialise_hamiltonian_hermitian : &initialise_hamiltonian;
+		auto init_sigma = hermitian ? &initialise_sigma_hermitian : &initialise_sigma;
+		if (hermitian)
+		{
+			init_hamiltonian(hamiltonian, dim);
+			init_sigma(sigma_in, sigma_out, dim, num);
+			compute_reference("commutator_reference_hermitian");
+		}
+
+		for (size_t k = 0; k < table->num_kernels; ++k)
+		{
+			kernel_table_entry const& entry = table->kernels[k];
+			if (entry.hermitian_only != hermitian)
+				continue;
+			if (entry.real_hamiltonian_only && !real_hamiltonian)
+				continue;
+
+			// pre-scale hamiltonian and transform memory layout
+			init_hamiltonian(hamiltonian, dim);
+			transform_matrix_scale_aos(hamiltonian, dim, dt / hbar);
+			entry.transformation_hamiltonian(hamiltonian, dim);
+
+			init_sigma(sigma_in, sigma_out, dim, num);
+			std::memcpy(sigma_reference_transformed, sigma_reference, size_sigma_byte);
+			entry.transformation_sigma(sigma_reference_transformed, dim, num, vec_length);
+			entry.transformation_sigma(sigma_in, dim, num, vec_length);
+
+			// BENCHMARK
+			benchmark_kernel(
+				[&]() // lambda expression
+				{
+					entry.kernel(reinterpret_cast<real_t*>(sigma_in),
+					             reinterpret_cast<real_t*>(sigma_out),
+					             reinterpret_cast<real_t*>(hamiltonian),
+					             num, dim, 0.0, 0.0);
+				},
+				std::string(entry.name) + "_" + table->isa,
+				NUM_ITERATIONS,
+				NUM_WARMUP);
+
+			// compute deviation from reference	(small deviations are expected)
+			deviation = compare_matrices(sigma_out, sigma_reference_transformed, dim, num);
+			std::cerr << "Deviation:\t" << deviation << std::endl;
+		}
+	}
+
+	free(hamiltonian);
+	free(sigma_in);
+	free(sigma_out);
+	free(sigma_reference);
+	free(sigma_reference_transformed);
+
+	return 0;
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iostream>
+
+#include <algorithm> // min
+#include <cstring> // memcpy
+#include <cmath>
+
+#include "ham/util/time.hpp" // ham::util::time
+
+#include "common.hpp"
+#include "kernel/kernel.hpp"
+#include "kernel/commutator_package.hpp" // *_STEP_FLOPS
+
+using namespace ham::util;
+
+// number of time steps per kernel call
+#ifndef NUM_STEPS
+	#define NUM_STEPS 4
+#endif
+// number of time steps each package is advanced at once by the temporally
+// blocked kernels
+#ifndef TIME_BLOCK
+	#define TIME_BLOCK NUM_STEPS
+#endif
+// number of sigma matrices validated against the reference (it is slow)
+#ifndef NUM_CHECK
+	#define NUM_CHECK 4096
+#endif
+
+int main(void)
+{
+	print_compile_config(std::cerr);
+	std::cerr << "NUM_STEPS: " << NUM_STEPS << std::endl;
+	std::cerr << "TIME_BLOCK: " << TIME_BLOCK << std::endl;
+	std::cerr << "NUM_CHECK: " << NUM_CHECK << std::endl;
+
+	// constants
+	const size_t dim = DIM;
+	const size_t num = NUM;
+	const size_t num_check = std::min<size_t>(num, NUM_CHECK);
+	const real_t hbar = 1.0 / std::acos(-1.0); // == 1 / Pi
+	const real_t dt = 1.0e-3; 
+
+	real_t deviation = 0.0;
+
+	// allocate memory
+	size_t size_hamiltonian = dim * dim;
+	size_t size_sigma = size_hamiltonian * num;
+	size_t size_sigma_byte = sizeof(complex_t) * size_sigma;
+
+	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* hamiltonian_scaled = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* sigma = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
+
+	// initialise memory
+	initialise_hamiltonian(hamiltonian, dim);
+	std::memcpy(hamiltonian_scaled, hamiltonian, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_scale_aos(hamiltonian_scaled, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian_scaled, dim);
+
+	// print output header
+	std::cout << "name\t" << time::statistics::header_string() << std::endl;
+
+	// achieved floating point performance, average runtime is in ns
+	auto print_gflops = [&](double flops, double runtime)
+	{
+		std::cerr << "GFLOP/s:\t" << flops / runtime << std::endl;
+	};
+
+	// BENCHMARK: single commutator evaluation as baseline, one sweep per
+	//            commutator, no validation (see benchmark_omp)
+	initialise_sigma(sigma, sigma_reference, dim, num);
+	transform_matrices_aos_to_aosoa(sigma, dim, num, VEC_LENGTH);
+	print_gflops(16.0 * dim * dim * dim * num,
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				commutator_omp_manual_aosoa_constants_direct_perm(
+					reinterpret_cast<real_vec_t*>(sigma),
+					reinterpret_cast<real_vec_t*>(sigma_reference),
+					reinterpret_cast<real_t*>(hamiltonian_scaled),
+					num, dim, 0.0, 0.0);
+			},
+			"commutator_omp_manual_aosoa_constants_direct_perm",
+			NUM_ITERATIONS,
+			NUM_WARMUP));
+
+	// Lambda to: initialise and transform memory, benchmark, compare results
+	auto benchmark = [&](std::function<void()> kernel,
+	                     std::string name,
+	                     decltype(&propagate_reference_rk4) reference,
+	                     double step_flops)
+	{
+		initialise_sigma(sigma_reference, sigma, dim, num);
+		std::memcpy(sigma, sigma_reference, size_sigma_byte);
+
+		// reference for the first num_check matrices, same number of overall steps
+		reference(sigma_reference, hamiltonian, dim, num_check, hbar, dt, NUM_ITERATIONS * NUM_STEPS);
+		transform_matrices_aos_to_aosoa(sigma_reference, dim, num_check, VEC_LENGTH);
+		transform_matrices_aos_to_aosoa(sigma, dim, num, VEC_LENGTH);
+
+		double runtime = benchmark_kernel(kernel, name, NUM_ITERATIONS, NUM_WARMUP);
+		print_gflops(step_flops * NUM_STEPS * num, runtime);
+
+		// compute deviation from reference	(small deviations are expected)
+		deviation = compare_matrices(sigma, sigma_reference, dim, num_check);
+		std::cerr << "Deviation:\t" << deviation << std::endl;
+	};
+
+#define PROPAGATE_ARGUMENTS reinterpret_cast<real_vec_t*>(sigma),            \
+			    reinterpret_cast<real_t*>(hamiltonian_scaled), \
+			    num, dim, NUM_STEPS
+	// BENCHMARK: classical Runge-Kutta, stages fused per package
+	benchmark(
+		[&]() // lambda expression
+		{
+			propagate_omp_manual_aosoa_constants_rk4( PROPAGATE_ARGUMENTS );
+		},
+		"propagate_omp_manual_aosoa_constants_rk4",
+		&propagate_reference_rk4, RK4_STEP_FLOPS);
+
+	// BENCHMARK: low-storage Runge-Kutta, stages fused per package
+	benchmark(
+		[&]() // lambda expression
+		{
+			propagate_omp_manual_aosoa_constants_lsrk( PROPAGATE_ARGUMENTS );
+		},
+		"propagate_omp_manual_aosoa_constants_lsrk",
+		&propagate_reference_lsrk, LSRK_STEP_FLOPS);
+
+	// BENCHMARK: classical Runge-Kutta, temporally blocked
+	benchmark(
+		[&]() // lambda expression
+		{
+			propagate_omp_manual_aosoa_constants_rk4_blocked( PROPAGATE_ARGUMENTS, TIME_BLOCK );
+		},
+		"propagate_omp_manual_aosoa_constants_rk4_blocked",
+		&propagate_reference_rk4, RK4_STEP_FLOPS);
+
+	// BENCHMARK: low-storage Runge-Kutta, temporally blocked
+	benchmark(
+		[&]() // lambda expression
+		{
+			propagate_omp_manual_aosoa_constants_lsrk_blocked( PROPAGATE_ARGUMENTS, TIME_BLOCK );
+		},
+		"propagate_omp_manual_aosoa_constants_lsrk_blocked",
+		&propagate_reference_lsrk, LSRK_STEP_FLOPS);
+
+	// BENCHMARK: classical Runge-Kutta, one persistent parallel region,
+	//            sense-reversing barrier per step instead of fork/join
+	benchmark(
+		[&]() // lambda expression
+		{
+			propagate_omp_manual_aosoa_constants_rk4_persistent( PROPAGATE_ARGUMENTS, 1 );
+		},
+		"propagate_omp_manual_aosoa_constants_rk4_persistent_barrier",
+		&propagate_reference_rk4, RK4_STEP_FLOPS);
+
+	// BENCHMARK: same, no synchronisation between steps (independent packages)
+	benchmark(
+		[&]() // lambda expression
+		{
+			propagate_omp_manual_aosoa_constants_rk4_persistent( PROPAGATE_ARGUMENTS, 0 );
+		},
+		"propagate_omp_manual_aosoa_constants_rk4_persistent",
+		&propagate_reference_rk4, RK4_STEP_FLOPS);
+
+	free(hamiltonian);
+	free(hamiltonian_scaled);
+	free(sigma);
+	free(sigma_reference);
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iostream>
+
+#include <algorithm> // fill, max, max_element
+#include <cstring> // memcpy
+#include <cmath>
+#include <numeric> // accumulate
+#include <string>
+
+#include <omp.h>
+
+#include "ham/util/time.hpp" // ham::util::time
+
+#include "common.hpp"
+#include "schedule.hpp"
+#include "kernel/kernel.hpp"
+#include "kernel/commutator_package.hpp"
+
+using namespace ham::util;
+
+// cost of the most expensive package of the skewed workloads, in commutators
+#ifndef SCHEDULE_MAX_REPEAT
+	#define SCHEDULE_MAX_REPEAT 16
+#endif
+
+int main(void)
+{
+	print_compile_config(std::cerr);
+	std::cerr << "SCHEDULE_CACHE_BYTES: " << SCHEDULE_CACHE_BYTES << std::endl;
+	std::cerr << "SCHEDULE_MAX_REPEAT: " << SCHEDULE_MAX_REPEAT << std::endl;
+
+	// constants
+	const size_t dim = DIM;
+	const size_t num = NUM;
+	const real_t hbar = 1.0 / std::acos(-1.0); // == 1 / Pi
+	const real_t dt = 1.0e-3;
+
+	const int num_packages = num / VEC_LENGTH;
+	const size_t bytes_per_package = 2 * PACKAGE_SIZE * sizeof(real_vec_t); // in + out
+	const int num_threads = omp_get_max_threads();
+	std::cerr << "Threads: " << num_threads << ", chunk (packages): " << cache_chunk_packages(bytes_per_package) << std::endl;
+
+	real_t deviation = 0.0;
+
+	// allocate memory
+	size_t size_hamiltonian = dim * dim;
+	size_t size_sigma = size_hamiltonian * num;
+
+	complex_t* hamiltonian = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* hamiltonian_scaled = allocate_aligned<complex_t>(size_hamiltonian);
+	complex_t* sigma_in = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_out = allocate_aligned<complex_t>(size_sigma);
+	complex_t* sigma_reference = allocate_aligned<complex_t>(size_sigma);
+	int* repeat = allocate_aligned<int>(num_packages);
+	double* busy_time = allocate_aligned<double>(num_threads);
+	double* busy_time_sum = allocate_aligned<double>(num_threads);
+
+	initialise_hamiltonian(hamiltonian, dim);
+	std::memcpy(hamiltonian_scaled, hamiltonian, sizeof(complex_t) * size_hamiltonian);
+	transform_matrix_scale_aos(hamiltonian_scaled, dim, dt / hbar); // pre-scale hamiltonian
+	transform_matrix_aos_to_soa(hamiltonian_scaled, dim);
+
+	// body of all schedules: repeat[p] commutators for package p
+	auto body = [&](int first, int last)
+	{
+		real_vec_t const* in = reinterpret_cast<real_vec_t*>(sigma_in);
+		real_vec_t* out = reinterpret_cast<real_vec_t*>(sigma_out);
+		for (int p = first; p < last; ++p)
+			for (int r = 0; r < repeat[p]; ++r)
+				commutator_package(in + p * PACKAGE_SIZE, out + p * PACKAGE_SIZE, reinterpret_cast<real_t*>(hamiltonian_scaled));
+	};
+
+	// print output header
+	std::cout << "name\t" << time::statistics::header_string() << std::endl;
+
+	// Lambda to: benchmark one schedule, compare results, report busy times
+	auto benchmark = [&](schedule_kind kind, std::string workload)
+	{
+		initialise_sigma(sigma_in, sigma_out, dim, num);
+		transform_matrices_aos_to_aosoa(sigma_in, dim, num, VEC_LENGTH);
+		std::fill(busy_time_sum, busy_time_sum + num_threads, 0.0);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				schedule_packages(schedule{kind, 0}, num_packages, bytes_per_package, body, busy_time);
+				for (int t = 0; t < num_threads; ++t)
+					busy_time_sum[t] += busy_time[t];
+			},
+			"commutator_package_" + workload + "_" + schedule_name(kind),
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+
+		// compute deviation from reference	(small deviations are expected)
+		deviation = compare_matrices(sigma_out, sigma_reference, dim, num);
+		std::cerr << "Deviation:\t" << deviation << std::endl;
+
+		// busy time over all runs, imbalance == max / mean (1 is optimal)
+		double busy_max = *std::max_element(busy_time_sum, busy_time_sum + num_threads);
+		double busy_mean = std::accumulate(busy_time_sum, busy_time_sum + num_threads, 0.0) / num_threads;
+		std::cerr << "Busy time per thread (s):";
+		for (int t = 0; t < num_threads; ++t)
+			std::cerr << "\t" << busy_time_sum[t];
+		std::cerr << std::endl;
+		std::cerr << "Imbalance (max / mean):\t" << (busy_max / busy_mean) << std::endl;
+	};
+
+	// Lambda to: benchmark all schedules for the current repeat counts
+	auto benchmark_workload = [&](std::string workload)
+	{
+		// reference: commutator_reference repeat[p] times per package, with the
+		// same number of runs as the kernels
+		initialise_sigma(sigma_in, sigma_reference, dim, num);
+		benchmark_kernel(
+			[&]() // lambda expression
+			{
+				for (int p = 0; p < num_packages; ++p)
+					for (int r = 0; r < repeat[p]; ++r)
+						commutator_reference(sigma_in + p * VEC_LENGTH * size_hamiltonian,
+						                     sigma_reference + p * VEC_LENGTH * size_hamiltonian,
+						                     hamiltonian, dim, VEC_LENGTH, hbar, dt);
+			},
+			"commutator_reference_" + workload,
+			NUM_ITERATIONS,
+			NUM_WARMUP);
+		transform_matrices_aos_to_aosoa(sigma_reference, dim, num, VEC_LENGTH);
+
+		for (schedule_kind kind : { schedule_kind::omp_static, schedule_kind::omp_dynamic,
+		                            schedule_kind::omp_guided, schedule_kind::work_stealing })
+			benchmark(kind, workload);
+	};
+
+	// BENCHMARK: uniform, one commutator per package
+	std::fill(repeat, repeat + num_packages, 1);
+	benchmark_workload("uniform");
+
+	// BENCHMARK: skewed, linear ramp from 1 to SCHEDULE_MAX_REPEAT commutators,
+	// e.g. a hierarchy with members sorted by level
+	for (int p = 0; p < num_packages; ++p)
+		repeat[p] = 1 + ((SCHEDULE_MAX_REPEAT - 1) * p) / std::max(1, num_packages - 1);
+	benchmark_workload("ramp");
+
+	// BENCHMARK: skewed, the first eighth of the packages costs
+	// SCHEDULE_MAX_REPEAT commutators, rest is uniform
+	for (int p = 0; p < num_packages; ++p)
+		repeat[p] = (p < num_packages / 8) ? SCHEDULE_MAX_REPEAT : 1;
+	benchmark_workload("hotspot");
+
+	free(hamiltonian);
+	free(hamiltonian_scaled);
+	free(sigma_in);
+	free(sigma_out);
+	free(sigma_reference);
+	free(repeat);
+	free(busy_time);
+	free(busy_time_sum);
+
+	return 0;
+}
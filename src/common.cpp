@@ -5,8 +5,10 @@
 
 #include "common.hpp"
 
+#include <algorithm> // min, max, fill
 #include <cstring> // memcpy
 #include <cmath> // abs
+#include <limits>
 #include <iostream>
 
 #include "ham/util/time.hpp"
@@ -34,6 +36,8 @@ void print_compile_config(std::ostream& out)
 		out << "VEC_VC";
 	#elif defined(VEC_VCL)
 		out << "VEC_VCL";
+	#elif defined(VEC_STDSIMD)
+		out << "VEC_STDSIMD";
 	#else
 		out << "NO_VEC_LIB";
 	#endif
@@ -42,6 +46,7 @@ void print_compile_config(std::ostream& out)
              	out << "USE_INITZERO" << std::endl;
         #endif
 	out << "VEC_LENGTH: " << VEC_LENGTH << std::endl;
+	out << "NUM_JUMP_OPS: " << NUM_JUMP_OPS << std::endl;
 }
 
 void initialise_sigma(complex_t* sigma_in, complex_t* sigma_out, size_t dim, size_t num)
@@ -67,12 +72,235 @@ void initialise_hamiltonian(complex_t* hamiltonian, size_t dim)
 	}
 }
 
+void initialise_sigma_hermitian(complex_t* sigma_in, complex_t* sigma_out, size_t dim, size_t num)
+{
+	size_t size_sigma = dim * dim;
+	#pragma omp parallel for
+	for (size_t sigma_id = 0; sigma_id < num; ++sigma_id)
+		for (size_t i = 0; i < dim; ++i)
+			for (size_t j = 0; j < dim; ++j)
+			{
+				// values are taken from the upper triangle, the lower triangle
+				// is its complex conjugate, the diagonal is real
+				real_t x = static_cast<real_t>(sigma_id) / num;
+				real_t y = static_cast<real_t>(std::min(i, j) * dim + std::max(i, j)) / size_sigma;
+				real_t imag = (i < j) ? (y - x) : ((i > j) ? (x - y) : 0.0);
+				sigma_in[sigma_id * size_sigma + i * dim + j] = complex_t(x - y, imag);
+				sigma_out[sigma_id * size_sigma + i * dim + j] = complex_t(0.0, 0.0);
+			}
+}
+
+void initialise_hamiltonian_hermitian(complex_t* hamiltonian, size_t dim)
+{
+	size_t size = dim * dim;
+	for (size_t i = 0; i < dim; ++i)
+		for (size_t j = 0; j < dim; ++j)
+		{
+			// real symmetric, i.e. Hermitian
+			hamiltonian[i * dim + j] = 1.0 - static_cast<real_t>(std::min(i, j) * dim + std::max(i, j)) / size;
+		}
+}
+
+void initialise_hamiltonians(complex_t* hamiltonians, size_t dim, size_t num)
+{
+	const size_t size = dim * dim;
+	#pragma omp parallel for
+	for (size_t m = 0; m < num; ++m)
+	{
+		complex_t* hamiltonian = hamiltonians + m * size;
+		initialise_hamiltonian(hamiltonian, dim);
+		// diagonal disorder in [0, 0.1), hashed from matrix and row index
+		for (size_t i = 0; i < dim; ++i)
+			hamiltonian[i * dim + i] += 0.1 * static_cast<real_t>((m * 7919 + i * 104729) % 1000) / 1000;
+	}
+}
+
+void initialise_dipole(complex_t* dipole, size_t dim)
+{
+	for (size_t i = 0; i < dim; ++i)
+		for (size_t j = 0; j < dim; ++j)
+		{
+			// couples all states, decaying with the distance of i and j,
+			// the lower triangle is the complex conjugate of the upper one
+			real_t distance = static_cast<real_t>(std::max(i, j) - std::min(i, j));
+			real_t imag = (i < j) ? 0.1 * distance / dim : ((i > j) ? -0.1 * distance / dim : 0.0);
+			dipole[i * dim + j] = (i == j) ? complex_t(0.0, 0.0) : complex_t(1.0 / (distance + 1.0), imag);
+		}
+}
+
+void initialise_jump_operators(complex_t* jump_operators, size_t dim, size_t num)
+{
+	const size_t size = dim * dim;
+	for (size_t l = 0; l < num; ++l)
+		for (size_t i = 0; i < dim; ++i)
+			for (size_t j = 0; j < dim; ++j)
+			{
+				// rate decreases with l, i.e. sqrt(rate) scales the operator
+				real_t amplitude = std::sqrt(0.1 / (l + 1));
+				real_t phase = 0.3 * i;
+				jump_operators[l * size + i * dim + j] = (j == i + l + 1) ? std::polar(amplitude, phase) : complex_t(0.0, 0.0);
+			}
+}
+
+void initialise_dephasing_operators(complex_t* jump_operators, size_t dim, size_t num)
+{
+	const size_t size = dim * dim;
+	for (size_t l = 0; l < num; ++l)
+		for (size_t i = 0; i < dim; ++i)
+			for (size_t j = 0; j < dim; ++j)
+			{
+				// site energy fluctuations of differing strength per state
+				real_t amplitude = std::sqrt(0.1 / (l + 1)) * static_cast<real_t>((i * (l + 3)) % dim) / dim;
+				jump_operators[l * size + i * dim + j] = (i == j) ? complex_t(amplitude, 0.0) : complex_t(0.0, 0.0);
+			}
+}
+
+bool is_real_matrix(complex_t const* matrix, size_t dim)
+{
+	for (size_t i = 0; i < dim * dim; ++i)
+		if (matrix[i].imag() != 0.0)
+			return false;
+	return true;
+}
+
+void diagonalise_hermitian(complex_t const* matrix, size_t dim, real_t* eigenvalues, complex_t* eigenvectors)
+{
+	const size_t max_sweeps = 64;
+
+	// work on a copy, eigenvectors start as identity
+	complex_t* a = new complex_t[dim * dim];
+	std::memcpy(a, matrix, sizeof(complex_t) * dim * dim);
+	for (size_t i = 0; i < dim; ++i)
+		for (size_t j = 0; j < dim; ++j)
+			eigenvectors[i * dim + j] = (i == j) ? 1.0 : 0.0;
+
+	// cyclic Jacobi method with complex rotations
+	for (size_t sweep = 0; sweep < max_sweeps; ++sweep)
+	{
+		real_t off_norm = 0.0;
+		real_t diag_norm = 0.0;
+		for (size_t p = 0; p < dim; ++p)
+		{
+			diag_norm += std::norm(a[p * dim + p]);
+			for (size_t q = p + 1; q < dim; ++q)
+				off_norm += std::norm(a[p * dim + q]);
+		}
+		if (off_norm <= std::numeric_limits<real_t>::epsilon() * std::numeric_limits<real_t>::epsilon() * diag_norm)
+			break;
+
+		for (size_t p = 0; p < dim; ++p)
+		{
+			for (size_t q = p + 1; q < dim; ++q)
+			{
+				real_t abs_pq = std::abs(a[p * dim + q]);
+				if (abs_pq == 0.0)
+					continue;
+
+				// J = diag(1, conj(e)) * R, with the phase e of a_pq and the real
+				// rotation R that annihilates the (now real) off-diagonal element
+				complex_t e_conj = std::conj(a[p * dim + q]) / abs_pq;
+				real_t theta = (a[q * dim + q].real() - a[p * dim + p].real()) / (2.0 * abs_pq);
+				real_t t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+				real_t c = 1.0 / std::sqrt(t * t + 1.0);
+				real_t s = t * c;
+
+				// a = a * J, v = v * J (columns p and q)
+				for (size_t k = 0; k < dim; ++k)
+				{
+					complex_t a_kp = a[k * dim + p];
+					complex_t a_kq = a[k * dim + q];
+					a[k * dim + p] = c * a_kp - s * e_conj * a_kq;
+					a[k * dim + q] = s * a_kp + c * e_conj * a_kq;
+					complex_t v_kp = eigenvectors[k * dim + p];
+					complex_t v_kq = eigenvectors[k * dim + q];
+					eigenvectors[k * dim + p] = c * v_kp - s * e_conj * v_kq;
+					eigenvectors[k * dim + q] = s * v_kp + c * e_conj * v_kq;
+				}
+				// a = J^H * a (rows p and q)
+				for (size_t k = 0; k < dim; ++k)
+				{
+					complex_t a_pk = a[p * dim + k];
+					complex_t a_qk = a[q * dim + k];
+					a[p * dim + k] = c * a_pk - s * std::conj(e_conj) * a_qk;
+					a[q * dim + k] = s * a_pk + c * std::conj(e_conj) * a_qk;
+				}
+				a[p * dim + q] = 0.0;
+				a[q * dim + p] = 0.0;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < dim; ++i)
+		eigenvalues[i] = a[i * dim + i].real();
+
+	delete [] a;
+}
+
+void transform_matrix_conjugate_transpose(complex_t* matrix, size_t dim)
+{
+	for (size_t i = 0; i < dim; ++i)
+	{
+		matrix[i * dim + i] = std::conj(matrix[i * dim + i]);
+		for (size_t j = i + 1; j < dim; ++j)
+		{
+			complex_t tmp = matrix[i * dim + j];
+			matrix[i * dim + j] = std::conj(matrix[j * dim + i]);
+			matrix[j * dim + i] = std::conj(tmp);
+		}
+	}
+}
+
 void transform_matrix_scale_aos(complex_t* matrix, size_t dim, real_t factor)
 {
 	for (size_t i = 0; i < dim * dim; ++i)
 		matrix[i] *= factor;
 }
 
+void transform_matrix_aos_to_soa_lindblad(complex_t* hamiltonian, complex_t const* jump_operators, size_t num_jump_operators, size_t dim, real_t dt)
+{
+	const size_t size = dim * dim;
+	complex_t* effective = hamiltonian;
+	complex_t* effective_adjoint = hamiltonian + size;
+
+	// A = hamiltonian - i * dt / 2 * sum_l L_l^H L_l
+	for (size_t l = 0; l < num_jump_operators; ++l)
+	{
+		complex_t const* jump_operator = jump_operators + l * size;
+		for (size_t i = 0; i < dim; ++i)
+			for (size_t j = 0; j < dim; ++j)
+			{
+				complex_t tmp = 0.0;
+				for (size_t k = 0; k < dim; ++k)
+					tmp += std::conj(jump_operator[k * dim + i]) * jump_operator[k * dim + j];
+				effective[i * dim + j] -= complex_t(0.0, 0.5 * dt) * tmp;
+			}
+	}
+
+	// A^H
+	std::memcpy(effective_adjoint, effective, sizeof(complex_t) * size);
+	transform_matrix_conjugate_transpose(effective_adjoint, dim);
+
+	transform_matrix_aos_to_soa(effective, dim);
+	transform_matrix_aos_to_soa(effective_adjoint, dim);
+}
+
+void dephasing_rates(complex_t const* jump_operators, size_t num_jump_operators, size_t dim, real_t dt, real_t* rates)
+{
+	const size_t size = dim * dim;
+	for (size_t i = 0; i < dim; ++i)
+		for (size_t j = 0; j < dim; ++j)
+		{
+			// L sigma L^H - 1/2 {L^H L, sigma} = -1/2 (l_i - l_j)^2 sigma_ij for L = diag(l)
+			real_t rate = 0.0;
+			for (size_t l = 0; l < num_jump_operators; ++l)
+			{
+				real_t difference = jump_operators[l * size + i * dim + i].real() - jump_operators[l * size + j * dim + j].real();
+				rate += 0.5 * difference * difference;
+			}
+			rates[i * dim + j] = dt * rate;
+		}
+}
+
 void transform_matrix_aos_to_soa(complex_t* matrix, size_t dim)
 {
 	size_t size = dim * dim;
@@ -95,55 +323,125 @@ void transform_matrix_aos_to_soa(complex_t* matrix, size_t dim)
 	delete [] matrix_tmp;
 }
 
-void transform_matrices_aos_to_aosoa(complex_t* matrices, size_t dim, size_t num, size_t vec_length)
+void transform_matrix_aos_to_soa_3m(complex_t* matrix, size_t dim)
 {
-	// indexing macros for the transformed data layout
-	//#define package_id ((n / vec_length) * vec_length * 2 * dim * dim)
-	auto package_id = [&](size_t m) { return (m / vec_length) * vec_length * 2 * dim * dim; };
-	//#define sigma_id (n % vec_length)
-	auto sigma_id = [&](size_t m) { return m % vec_length; };
-	//#define sigma_real(i, j) (package_id + 2 * vec_length * (dim * (i) + (j)) + sigma_id)
-	auto sigma_real = [&](size_t i, size_t j, size_t m) { return package_id(m) + 2 * vec_length * (dim * i + j) + sigma_id(m); };
-	//#define sigma_imag(i, j) (package_id + 2 * vec_length * (dim * (i) + (j)) + vec_length + sigma_id)
-	auto sigma_imag = [&](size_t i, size_t j, size_t m) { return package_id(m) + 2 * vec_length * (dim * i + j) + vec_length + sigma_id(m); };
-
-	size_t size = num * dim * dim;
+	size_t size = dim * dim;
 
 	// create a temporary copy of matrix
-	complex_t* matrices_tmp = new complex_t[size];
-	std::memcpy(matrices_tmp, matrices, sizeof(complex_t) * size);
-
+	complex_t* matrix_tmp = new complex_t[size];
+	std::memcpy(matrix_tmp, matrix, sizeof(complex_t) * size);
+	
 	// copy back with new layout
-	real_t* matrices_r = reinterpret_cast<real_t*>(matrices);
+	real_t* matrix_r = reinterpret_cast<real_t*>(matrix);
 	#pragma omp parallel for
-	for (size_t m = 0; m < num; ++m)
+	for (size_t i = 0; i < dim; ++i)
+		for (size_t j = 0; j < dim; ++j)
+		{
+			complex_t value = matrix_tmp[i * dim + j];
+			matrix_r[i * dim + j] = value.real();
+			matrix_r[size + i * dim + j] = value.real() + value.imag();
+			matrix_r[2 * size + i * dim + j] = value.imag() - value.real();
+		}
+
+	delete [] matrix_tmp;
+}
+
+// in-place transform between AoS and an AoSoA layout, package by package:
+// a package of vec_length matrices occupies the same memory in both layouts,
+// so each thread only needs a scratch buffer for one package
+// AoSoA package layout: element e (== i * dim + j) of lane v has its real part
+// at e * stride + v and its imaginary part at imag_offset + e * stride + v
+static void transform_matrices_packages(complex_t* matrices, size_t dim, size_t num, size_t vec_length,
+                                        size_t stride, size_t imag_offset, bool to_aos)
+{
+	const size_t size = dim * dim; // elements per matrix
+	const size_t package_size = vec_length * size; // complex elements per package
+
+	#pragma omp parallel
 	{
-		for (size_t i = 0; i < dim; ++i)
+		// per-thread scratch buffer
+		real_t* tmp = reinterpret_cast<real_t*>(allocate_aligned<complex_t>(package_size));
+
+		#pragma omp for
+		for (size_t p = 0; p < num / vec_length; ++p)
 		{
-			for (size_t j = 0; j < dim; ++j)
+			real_t* package = reinterpret_cast<real_t*>(matrices + p * package_size);
+			std::memcpy(tmp, package, sizeof(complex_t) * package_size);
+			if (to_aos)
 			{
-				matrices_r[sigma_real(i, j, m)] = matrices_tmp[m * dim * dim + i * dim + j].real();
-				matrices_r[sigma_imag(i, j, m)] = matrices_tmp[m * dim * dim + i * dim + j].imag();				
+				for (size_t v = 0; v < vec_length; ++v)
+				{
+					#pragma omp simd
+					for (size_t e = 0; e < size; ++e)
+					{
+						package[2 * (v * size + e)] = tmp[e * stride + v];
+						package[2 * (v * size + e) + 1] = tmp[imag_offset + e * stride + v];
+					}
+				}
+			}
+			else
+			{
+				for (size_t e = 0; e < size; ++e)
+				{
+					#pragma omp simd
+					for (size_t v = 0; v < vec_length; ++v)
+					{
+						package[e * stride + v] = tmp[2 * (v * size + e)];
+						package[imag_offset + e * stride + v] = tmp[2 * (v * size + e) + 1];
+					}
+				}
 			}
 		}
+
+		free(tmp);
 	}
+}
 
-	delete [] matrices_tmp;
+void transform_matrices_aos_to_aosoa(complex_t* matrices, size_t dim, size_t num, size_t vec_length)
+{
+	// sigma_real(i, j) == package_id + 2 * vec_length * (dim * (i) + (j)) + sigma_id
+	// sigma_imag(i, j) == package_id + 2 * vec_length * (dim * (i) + (j)) + vec_length + sigma_id
+	transform_matrices_packages(matrices, dim, num, vec_length, 2 * vec_length, vec_length, false);
+}
+
+void transform_matrices_aosoa_to_aos(complex_t* matrices, size_t dim, size_t num, size_t vec_length)
+{
+	transform_matrices_packages(matrices, dim, num, vec_length, 2 * vec_length, vec_length, true);
 }
 
 void transform_matrices_aos_to_aosoa_gpu(complex_t* matrices, size_t dim, size_t num, size_t vec_length)
 {
-	// lambdas for indexing
-	auto package_id = [&](size_t m) { return (m / vec_length) * vec_length * 2 * dim * dim; };
+	// sigma_real(i, j) == package_id + vec_length * (dim * (i) + (j)) + sigma_id
+	// sigma_imag(i, j) == package_id + dim * dim * vec_length + vec_length * (dim * (i) + (j)) + sigma_id
+	transform_matrices_packages(matrices, dim, num, vec_length, vec_length, dim * dim * vec_length, false);
+}
+
+void transform_matrices_aosoa_gpu_to_aos(complex_t* matrices, size_t dim, size_t num, size_t vec_length)
+{
+	transform_matrices_packages(matrices, dim, num, vec_length, vec_length, dim * dim * vec_length, true);
+}
+
+void transform_matrices_aos_to_aosoa_hermitian(complex_t* matrices, size_t dim, size_t num, size_t vec_length)
+{
+	// lambdas for indexing, offdiag_id enumerates the strict upper triangle row by row
+	auto package_id = [&](size_t m) { return (m / vec_length) * vec_length * dim * dim; };
 	auto sigma_id = [&](size_t m) { return m % vec_length; };
-	auto sigma_real = [&](size_t i, size_t j, size_t m) { return package_id(m) + vec_length * (dim * i + j) + sigma_id(m); };
-	auto sigma_imag = [&](size_t i, size_t j, size_t m) { return package_id(m) + dim * dim * vec_length + vec_length * (dim * i + j) + sigma_id(m); };
+	auto offdiag_id = [&](size_t i, size_t j) { return i * (2 * dim - i - 1) / 2 + j - i - 1; };
+	auto sigma_diag = [&](size_t i, size_t m) { return package_id(m) + vec_length * i + sigma_id(m); };
+	auto sigma_real = [&](size_t i, size_t j, size_t m) { return package_id(m) + vec_length * (dim + 2 * offdiag_id(i, j)) + sigma_id(m); };
+	auto sigma_imag = [&](size_t i, size_t j, size_t m) { return package_id(m) + vec_length * (dim + 2 * offdiag_id(i, j)) + vec_length + sigma_id(m); };
 
 	size_t size = num * dim * dim;
 
 	// create a temporary copy of matrix
 	complex_t* matrices_tmp = new complex_t[size];
-	std::memcpy(matrices_tmp, matrices, sizeof(complex_t) * size);
+	// NOTE: parallel copy with the schedule of the loop below, i.e. each thread
+	//       first-touches and later reads its own part of the copy (NUMA)
+	#pragma omp parallel for
+	for (size_t m = 0; m < num; ++m)
+		std::memcpy(matrices_tmp + m * dim * dim, matrices + m * dim * dim, sizeof(complex_t) * dim * dim);
+	// the packed data occupies the first half, the unused rest is zeroed
+	std::fill(matrices, matrices + size, complex_t(0.0, 0.0));
 
 	// copy back with new layout
 	real_t* matrices_r = reinterpret_cast<real_t*>(matrices);
@@ -152,10 +450,11 @@ void transform_matrices_aos_to_aosoa_gpu(complex_t* matrices, size_t dim, size_t
 	{
 		for (size_t i = 0; i < dim; ++i)
 		{
-			for (size_t j = 0; j < dim; ++j)
+			matrices_r[sigma_diag(i, m)] = matrices_tmp[m * dim * dim + i * dim + i].real();
+			for (size_t j = i + 1; j < dim; ++j)
 			{
 				matrices_r[sigma_real(i, j, m)] = matrices_tmp[m * dim * dim + i * dim + j].real();
-				matrices_r[sigma_imag(i, j, m)] = matrices_tmp[m * dim * dim + i * dim + j].imag();				
+				matrices_r[sigma_imag(i, j, m)] = matrices_tmp[m * dim * dim + i * dim + j].imag();
 			}
 		}
 	}
@@ -177,7 +476,7 @@ real_t compare_matrices(complex_t* a, complex_t* b, size_t dim, size_t num)
 	return deviation;
 }
 
-void benchmark_kernel(std::function<void()> kernel, std::string name, size_t overall_runs, size_t warmup_runs)
+double benchmark_kernel(std::function<void()> kernel, std::string name, size_t overall_runs, size_t warmup_runs)
 {
 	time::statistics stats(overall_runs, warmup_runs);
 	for (size_t i = 0; i < overall_runs; ++i)
@@ -187,5 +486,6 @@ void benchmark_kernel(std::function<void()> kernel, std::string name, size_t ove
 		stats.add(t);
 	}
 	std::cout << name << "\t" << stats.string() << std::endl;
+	return stats.average();
 }
 
@@ -0,0 +1,56 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib> // getenv
+#include <cstring> // strcmp
+#include <iostream>
+
+#include "kernel/kernel_table.hpp"
+
+kernel_table const* select_kernel_table()
+{
+	__builtin_cpu_init();
+
+	// ordered from fastest to slowest, the tables of levels that were not
+	// built are null
+	struct candidate
+	{
+		kernel_table const* table;
+		const char* isa;
+		int supported; // __builtin_cpu_supports() returns int
+	};
+	const candidate candidates[] = {
+		{ &kernel_table_avx512, "avx512", __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd")
+		                               && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")
+		                               && __builtin_cpu_supports("avx512vl") },
+		{ &kernel_table_avx2, "avx2", __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") },
+		{ &kernel_table_sse42, "sse42", __builtin_cpu_supports("sse4.2") }
+	};
+
+	const char* forced_isa = std::getenv("HEXCITON_ISA");
+	if (forced_isa && forced_isa[0] == '\0')
+		forced_isa = nullptr;
+	for (const candidate& c : candidates)
+	{
+		if (!c.table)
+			continue;
+		if (forced_isa)
+		{
+			if (std::strcmp(forced_isa, c.isa) != 0)
+				continue;
+			if (!c.supported)
+				std::cerr << "Warning: forced ISA " << c.isa << " is not supported by this CPU." << std::endl;
+			return c.table;
+		}
+		if (c.supported)
+			return c.table;
+	}
+
+	if (forced_isa)
+		std::cerr << "Error: no kernels were built for HEXCITON_ISA=" << forced_isa << std::endl;
+	else
+		std::cerr << "Error: no kernels were built for an ISA supported by this CPU." << std::endl;
+	return nullptr;
+}
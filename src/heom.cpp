@@ -0,0 +1,297 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "heom.hpp"
+
+#include <algorithm> // sort, reverse
+#include <cmath>
+#include <cstdlib> // free, abs
+#include <cstring> // memcpy
+#include <list>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+size_t heom_hierarchy_size(int num_modes, int depth)
+{
+	// binomial(num_modes + depth, depth), exact in each step
+	size_t size = 1;
+	for (int i = 1; i <= depth; ++i)
+		size = size * (num_modes + i) / i;
+	return size;
+}
+
+// appends all occupation vectors with sum_k n_k == level in lexicographical order
+static void enumerate_level(std::vector<int>& occupation, int mode, int remaining, std::vector<std::vector<int>>& members)
+{
+	if (mode == static_cast<int>(occupation.size()) - 1)
+	{
+		occupation[mode] = remaining;
+		members.push_back(occupation);
+		return;
+	}
+	for (int n = remaining; n >= 0; --n)
+	{
+		occupation[mode] = n;
+		enumerate_level(occupation, mode + 1, remaining - n, members);
+	}
+}
+
+heom_hierarchy build_heom_hierarchy(int num_modes, int depth, int dim, real_t dt)
+{
+	heom_hierarchy hierarchy;
+	hierarchy.num_modes = num_modes;
+	hierarchy.depth = depth;
+
+	// members, ordered by level
+	std::vector<std::vector<int>> members;
+	std::vector<int> occupation(num_modes, 0);
+	for (int level = 0; level <= depth; ++level)
+		enumerate_level(occupation, 0, level, members);
+	hierarchy.num_members = static_cast<int>(members.size());
+
+	std::map<std::vector<int>, int> member_index;
+	for (int m = 0; m < hierarchy.num_members; ++m)
+		member_index[members[m]] = m;
+
+	// high-temperature Drude-Lorentz bath per mode: reorganisation energy lambda,
+	// cut-off gamma, c_k = 2 lambda k_B T - i lambda gamma, modes are distributed
+	// over the sites round robin
+	const real_t lambda = 0.1;
+	const real_t temperature = 1.0; // k_B T
+	std::vector<real_t> gamma(num_modes);
+	std::vector<complex_t> c(num_modes);
+	hierarchy.site = allocate_aligned<int>(num_modes);
+	for (int k = 0; k < num_modes; ++k)
+	{
+		hierarchy.site[k] = k % dim;
+		gamma[k] = 0.5 + 0.1 * (k % 3);
+		c[k] = complex_t(2.0 * lambda * temperature, -lambda * gamma[k]);
+	}
+
+	hierarchy.occupation = allocate_aligned<int>(hierarchy.num_members * num_modes);
+	hierarchy.neighbour = allocate_aligned<int>(hierarchy.num_members * 2 * num_modes);
+	hierarchy.coupling = allocate_aligned<real_t>(hierarchy.num_members * 3 * num_modes);
+	hierarchy.damping = allocate_aligned<real_t>(hierarchy.num_members);
+
+	for (int m = 0; m < hierarchy.num_members; ++m)
+	{
+		std::vector<int> n = members[m];
+		real_t damping = 0.0;
+		for (int k = 0; k < num_modes; ++k)
+		{
+			hierarchy.occupation[m * num_modes + k] = n[k];
+			damping += n[k] * gamma[k];
+
+			// scaled HEOM: up ~ sqrt((n_k + 1) |c_k|), down ~ sqrt(n_k / |c_k|) c_k
+			const real_t c_abs = std::abs(c[k]);
+			int* neighbour = hierarchy.neighbour + (m * num_modes + k) * 2;
+			real_t* coupling = hierarchy.coupling + (m * num_modes + k) * 3;
+
+			// up: n + e_k
+			std::vector<int> up = n;
+			++up[k];
+			auto it = member_index.find(up);
+			neighbour[0] = (it != member_index.end()) ? it->second : m;
+			coupling[0] = (it != member_index.end()) ? dt * std::sqrt((n[k] + 1) * c_abs) : 0.0;
+
+			// down: n - e_k
+			if (n[k] > 0)
+			{
+				std::vector<int> down = n;
+				--down[k];
+				complex_t down_coupling = dt * std::sqrt(n[k] / c_abs) * c[k];
+				neighbour[1] = member_index[down];
+				coupling[1] = down_coupling.real();
+				coupling[2] = down_coupling.imag();
+			}
+			else
+			{
+				neighbour[1] = m;
+				coupling[1] = 0.0;
+				coupling[2] = 0.0;
+			}
+		}
+		hierarchy.damping[m] = dt * damping;
+	}
+
+	return hierarchy;
+}
+
+void free_heom_hierarchy(heom_hierarchy& hierarchy)
+{
+	free(hierarchy.site);
+	free(hierarchy.occupation);
+	free(hierarchy.neighbour);
+	free(hierarchy.coupling);
+	free(hierarchy.damping);
+}
+
+// distinct neighbours of each member (without itself)
+static std::vector<std::vector<int>> heom_adjacency(heom_hierarchy const& hierarchy)
+{
+	std::vector<std::vector<int>> adjacency(hierarchy.num_members);
+	for (int m = 0; m < hierarchy.num_members; ++m)
+	{
+		for (int i = 0; i < 2 * hierarchy.num_modes; ++i)
+		{
+			int n = hierarchy.neighbour[m * 2 * hierarchy.num_modes + i];
+			if (n != m)
+				adjacency[m].push_back(n);
+		}
+		std::sort(adjacency[m].begin(), adjacency[m].end());
+		adjacency[m].erase(std::unique(adjacency[m].begin(), adjacency[m].end()), adjacency[m].end());
+	}
+	return adjacency;
+}
+
+void heom_rcm_permutation(heom_hierarchy const& hierarchy, int* permutation)
+{
+	const int num_members = hierarchy.num_members;
+	std::vector<std::vector<int>> adjacency = heom_adjacency(hierarchy);
+	auto by_degree = [&](int a, int b)
+	{
+		return adjacency[a].size() < adjacency[b].size() || (adjacency[a].size() == adjacency[b].size() && a < b);
+	};
+
+	std::vector<bool> visited(num_members, false);
+	std::vector<int> order;
+	order.reserve(num_members);
+	// breadth-first search from a member of minimal degree, per connected component
+	while (static_cast<int>(order.size()) < num_members)
+	{
+		int start = -1;
+		for (int m = 0; m < num_members; ++m)
+			if (!visited[m] && (start < 0 || by_degree(m, start)))
+				start = m;
+
+		std::queue<int> queue;
+		queue.push(start);
+		visited[start] = true;
+		while (!queue.empty())
+		{
+			int m = queue.front();
+			queue.pop();
+			order.push_back(m);
+
+			std::vector<int> next;
+			for (int n : adjacency[m])
+				if (!visited[n])
+				{
+					visited[n] = true;
+					next.push_back(n);
+				}
+			std::sort(next.begin(), next.end(), by_degree);
+			for (int n : next)
+				queue.push(n);
+		}
+	}
+	std::reverse(order.begin(), order.end());
+
+	for (int m = 0; m < num_members; ++m)
+		permutation[m] = order[m];
+}
+
+void invert_permutation(int const* permutation, int* inverse, int size)
+{
+	for (int i = 0; i < size; ++i)
+		inverse[permutation[i]] = i;
+}
+
+void reorder_heom_hierarchy(heom_hierarchy& hierarchy, int const* permutation)
+{
+	const int num_members = hierarchy.num_members;
+	const int num_modes = hierarchy.num_modes;
+	std::vector<int> inverse(num_members);
+	invert_permutation(permutation, inverse.data(), num_members);
+
+	std::vector<int> occupation(hierarchy.occupation, hierarchy.occupation + num_members * num_modes);
+	std::vector<int> neighbour(hierarchy.neighbour, hierarchy.neighbour + num_members * 2 * num_modes);
+	std::vector<real_t> coupling(hierarchy.coupling, hierarchy.coupling + num_members * 3 * num_modes);
+	std::vector<real_t> damping(hierarchy.damping, hierarchy.damping + num_members);
+
+	for (int m = 0; m < num_members; ++m)
+	{
+		const int old = permutation[m];
+		for (int k = 0; k < num_modes; ++k)
+		{
+			hierarchy.occupation[m * num_modes + k] = occupation[old * num_modes + k];
+			for (int i = 0; i < 2; ++i)
+				hierarchy.neighbour[(m * num_modes + k) * 2 + i] = inverse[neighbour[(old * num_modes + k) * 2 + i]];
+			for (int i = 0; i < 3; ++i)
+				hierarchy.coupling[(m * num_modes + k) * 3 + i] = coupling[(old * num_modes + k) * 3 + i];
+		}
+		hierarchy.damping[m] = damping[old];
+	}
+}
+
+void permute_heom_members(complex_t* matrices, size_t dim, size_t num, size_t vec_length, int num_members, int const* permutation)
+{
+	const size_t size_package = dim * dim * vec_length;
+	const size_t size_hierarchy = size_package * num_members;
+	const size_t num_hierarchies = num / (vec_length * num_members);
+
+	// create a temporary copy of one hierarchy at a time
+	complex_t* hierarchy_tmp = new complex_t[size_hierarchy];
+	for (size_t h = 0; h < num_hierarchies; ++h)
+	{
+		complex_t* hierarchy = matrices + h * size_hierarchy;
+		std::memcpy(hierarchy_tmp, hierarchy, sizeof(complex_t) * size_hierarchy);
+		#pragma omp parallel for
+		for (int m = 0; m < num_members; ++m)
+			std::memcpy(hierarchy + m * size_package, hierarchy_tmp + permutation[m] * size_package, sizeof(complex_t) * size_package);
+	}
+	delete[] hierarchy_tmp;
+}
+
+real_t heom_gather_distance(heom_hierarchy const& hierarchy)
+{
+	size_t gathers = 0;
+	size_t distance = 0;
+	for (int m = 0; m < hierarchy.num_members; ++m)
+		for (int i = 0; i < 2 * hierarchy.num_modes; ++i)
+		{
+			distance += std::abs(hierarchy.neighbour[m * 2 * hierarchy.num_modes + i] - m);
+			++gathers;
+		}
+	return static_cast<real_t>(distance) / gathers;
+}
+
+real_t heom_gather_miss_rate(heom_hierarchy const& hierarchy, size_t cache_packages)
+{
+	// LRU list of packages, most recently used first
+	std::list<int> lru;
+	std::unordered_map<int, std::list<int>::iterator> cached;
+	auto access = [&](int package)
+	{
+		auto it = cached.find(package);
+		bool hit = it != cached.end();
+		if (hit)
+			lru.erase(it->second);
+		lru.push_front(package);
+		cached[package] = lru.begin();
+		if (lru.size() > cache_packages)
+		{
+			cached.erase(lru.back());
+			lru.pop_back();
+		}
+		return hit;
+	};
+
+	size_t gathers = 0;
+	size_t misses = 0;
+	for (int m = 0; m < hierarchy.num_members; ++m)
+	{
+		access(m); // the member itself is streamed
+		for (int i = 0; i < 2 * hierarchy.num_modes; ++i)
+		{
+			if (!access(hierarchy.neighbour[m * 2 * hierarchy.num_modes + i]))
+				++misses;
+			++gathers;
+		}
+	}
+	return static_cast<real_t>(misses) / gathers;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+// in-place basis transformation of all sigma matrices: sigma = basis^H * sigma * basis
+// NOTE: with basis = U (the eigenvectors of the Hamiltonian as columns) this
+//       transforms into the eigenbasis, with basis = U^H back into the original one
+void basis_transform_omp_manual_aosoa_constants(real_vec_t* restrict sigma, 
+                                                real_t const* restrict basis, 
+                                                const int num, const int dim)
+{
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+	for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+	{
+		#define package_id (global_id * DIM * DIM * 2)
+
+		#define sigma_real(i, j) (package_id + 2 * (DIM * (i) + (j)))
+		#define sigma_imag(i, j) (package_id + 2 * (DIM * (i) + (j)) + 1)
+
+		#define tmp_real(i, j) (2 * (DIM * (i) + (j)))
+		#define tmp_imag(i, j) (2 * (DIM * (i) + (j)) + 1)
+
+		#define basis_real(i, j) ((i) * DIM + (j))
+		#define basis_imag(i, j) (DIM * DIM + (i) * DIM + (j))
+
+		real_vec_t tmp[2 * DIM * DIM];
+
+		// tmp = basis^H * sigma
+		int i, j, k;
+		for (i = 0; i < DIM; ++i)
+		{
+			for (j = 0; j < DIM; ++j)
+			{
+				real_vec_t acc_real(real_t(0.0));
+				real_vec_t acc_imag(real_t(0.0));
+				for (k = 0; k < DIM; ++k)
+				{
+					// conj(basis(k, i)) * sigma(k, j)
+					acc_real += sigma[sigma_real(k, j)] * basis[basis_real(k, i)];
+					acc_real += sigma[sigma_imag(k, j)] * basis[basis_imag(k, i)];
+					acc_imag += sigma[sigma_imag(k, j)] * basis[basis_real(k, i)];
+					acc_imag -= sigma[sigma_real(k, j)] * basis[basis_imag(k, i)];
+				}
+				tmp[tmp_real(i, j)] = acc_real;
+				tmp[tmp_imag(i, j)] = acc_imag;
+			}
+		}
+
+		// sigma = tmp * basis
+		for (i = 0; i < DIM; ++i)
+		{
+			for (j = 0; j < DIM; ++j)
+			{
+				real_vec_t acc_real(real_t(0.0));
+				real_vec_t acc_imag(real_t(0.0));
+				for (k = 0; k < DIM; ++k)
+				{
+					acc_real += tmp[tmp_real(i, k)] * basis[basis_real(k, j)];
+					acc_real -= tmp[tmp_imag(i, k)] * basis[basis_imag(k, j)];
+					acc_imag += tmp[tmp_real(i, k)] * basis[basis_imag(k, j)];
+					acc_imag += tmp[tmp_imag(i, k)] * basis[basis_real(k, j)];
+				}
+				sigma[sigma_real(i, j)] = acc_real;
+				sigma[sigma_imag(i, j)] = acc_imag;
+			}
+		}
+	}
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "kernel/common.cl"
+
+// 3M (Gauss) complex multiplication, see commutator_omp_manual_aosoa_constants_3m.cpp,
+// hamiltonian holds the tables of transform_matrix_aos_to_soa_3m
+__kernel __attribute__((vec_type_hint(real_vec_t)))
+void commutator_ocl_manual_aosoa_constants_3m(__global real_vec_t const* restrict sigma_in,
+                                              __global real_vec_t* restrict sigma_out,
+                                              __global real_t const* restrict hamiltonian,
+                                              const int num, const int dim,
+                                              const real_t hbar, const real_t dt)
+{
+	// number of package to process == get_global_id(0)
+	#define package_id (get_global_id(0) * DIM * DIM * 2)
+
+	#define sigma_real(i, j) (package_id + 2 * (DIM * (i) + (j)))
+	#define sigma_imag(i, j) (package_id + 2 * (DIM * (i) + (j)) + 1)
+	#define sigma_sum(i, j) (DIM * (i) + (j))
+
+	#define ham_real(i, j) ((i) * DIM + (j))
+	#define ham_sum(i, j) (DIM * DIM + (i) * DIM + (j))
+	#define ham_diff(i, j) (2 * DIM * DIM + (i) * DIM + (j))
+
+	// real + imaginary part of all sigma elements of the package
+	real_vec_t sigma_sum_tmp[DIM * DIM];
+	int i, j, k;
+	for (i = 0; i < DIM; ++i)
+		for (j = 0; j < DIM; ++j)
+			sigma_sum_tmp[sigma_sum(i, j)] = sigma_in[sigma_real(i, j)] + sigma_in[sigma_imag(i, j)];
+
+	// compute commutator: (hamiltonian * sigma_in[sigma_id] - sigma_in[sigma_id] * hamiltonian)
+	for (i = 0; i < DIM; ++i)
+	{
+		for (j = 0; j < DIM; ++j)
+		{
+			real_vec_t k1 = 0.0;
+			real_vec_t k2 = 0.0;
+			real_vec_t k3 = 0.0;
+			for (k = 0; k < DIM; ++k)
+			{
+				// hamiltonian * sigma
+				k1 += hamiltonian[ham_real(i, k)] * sigma_sum_tmp[sigma_sum(k, j)];
+				k2 += hamiltonian[ham_sum(i, k)] * sigma_in[sigma_imag(k, j)];
+				k3 += hamiltonian[ham_diff(i, k)] * sigma_in[sigma_real(k, j)];
+				// - sigma * hamiltonian
+				k1 -= sigma_sum_tmp[sigma_sum(i, k)] * hamiltonian[ham_real(k, j)];
+				k2 -= sigma_in[sigma_imag(i, k)] * hamiltonian[ham_sum(k, j)];
+				k3 -= sigma_in[sigma_real(i, k)] * hamiltonian[ham_diff(k, j)];
+			}
+			// sigma_out -= i * commutator
+			sigma_out[sigma_real(i, j)] += k1 + k3;
+			sigma_out[sigma_imag(i, j)] += k2 - k1;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+// 3M (Gauss) complex multiplication, 3 instead of 4 real multiplications per
+// complex product: with x = a + ib, y = c + id
+//     k1 = a * (c + d), k2 = d * (a + b), k3 = c * (b - a)
+//     x * y = (k1 - k2) + i(k1 + k3)
+// x is the Hamiltonian for both products, (a + b) and (b - a) are precomputed
+// tables (transform_matrix_aos_to_soa_3m), c + d is computed once per package
+void commutator_omp_manual_aosoa_constants_3m(real_vec_t const* restrict sigma_in,
+                                              real_vec_t* restrict sigma_out,
+                                              real_t const* restrict hamiltonian,
+                                              const int num, const int dim,
+                                              const real_t hbar, const real_t dt)
+{
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+	for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+	{
+		// original OpenCL kernel begins here
+		#define package_id (global_id * DIM * DIM * 2)
+
+		#define sigma_real(i, j) (package_id + 2 * (DIM * (i) + (j)))
+		#define sigma_imag(i, j) (package_id + 2 * (DIM * (i) + (j)) + 1)
+		#define sigma_sum(i, j) (DIM * (i) + (j))
+
+		#define ham_real(i, j) ((i) * DIM + (j))
+		#define ham_sum(i, j) (DIM * DIM + (i) * DIM + (j))
+		#define ham_diff(i, j) (2 * DIM * DIM + (i) * DIM + (j))
+
+		// real + imaginary part of all sigma elements of the package
+		real_vec_t sigma_sum_tmp[DIM * DIM];
+		for (int i = 0; i < DIM; ++i)
+			for (int j = 0; j < DIM; ++j)
+				sigma_sum_tmp[sigma_sum(i, j)] = sigma_in[sigma_real(i, j)] + sigma_in[sigma_imag(i, j)];
+
+		// compute commutator: (hamiltonian * sigma_in[sigma_id] - sigma_in[sigma_id] * hamiltonian)
+		int i, j, k;
+		for (i = 0; i < DIM; ++i)
+		{
+			for (j = 0; j < DIM; ++j)
+			{
+				real_vec_t k1(real_t(0.0));
+				real_vec_t k2(real_t(0.0));
+				real_vec_t k3(real_t(0.0));
+				for (k = 0; k < DIM; ++k)
+				{
+					// hamiltonian * sigma
+					k1 += sigma_sum_tmp[sigma_sum(k, j)] * hamiltonian[ham_real(i, k)];
+					k2 += sigma_in[sigma_imag(k, j)] * hamiltonian[ham_sum(i, k)];
+					k3 += sigma_in[sigma_real(k, j)] * hamiltonian[ham_diff(i, k)];
+					// - sigma * hamiltonian
+					k1 -= sigma_sum_tmp[sigma_sum(i, k)] * hamiltonian[ham_real(k, j)];
+					k2 -= sigma_in[sigma_imag(i, k)] * hamiltonian[ham_sum(k, j)];
+					k3 -= sigma_in[sigma_real(i, k)] * hamiltonian[ham_diff(k, j)];
+				}
+				// sigma_out -= i * commutator
+				sigma_out[sigma_real(i, j)] += k1 + k3;
+				sigma_out[sigma_imag(i, j)] += k2 - k1;
+			}
+		}
+
+		#undef package_id
+		#undef sigma_real
+		#undef sigma_imag
+		#undef sigma_sum
+		#undef ham_real
+		#undef ham_sum
+		#undef ham_diff
+	}
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+#ifdef HOST_AVX512 // otherwise this kernel is not available
+
+#include <immintrin.h>
+
+// AVX-512 intrinsics version of commutator_omp_manual_aosoa_constants_direct_perm:
+// - one row of sigma_out is kept in registers while iterating over k
+// - Hamiltonian elements are broadcast and combined via FMA
+// - num does not need to be a multiple of VEC_LENGTH, the last package is
+//   processed with masked loads/stores (sigma must be allocated for whole packages)
+#ifdef SINGLE_PRECISION
+	typedef __m512 avx512_vec_t;
+	typedef __mmask16 avx512_mask_t;
+	#define avx512_load(mask, ptr) _mm512_maskz_load_ps(mask, ptr)
+	#define avx512_store(ptr, mask, a) _mm512_mask_store_ps(ptr, mask, a)
+	#define avx512_set1(a) _mm512_set1_ps(a)
+	#define avx512_fmadd(a, b, c) _mm512_fmadd_ps(a, b, c) // a * b + c
+	#define avx512_fnmadd(a, b, c) _mm512_fnmadd_ps(a, b, c) // -(a * b) + c
+#else
+	typedef __m512d avx512_vec_t;
+	typedef __mmask8 avx512_mask_t;
+	#define avx512_load(mask, ptr) _mm512_maskz_load_pd(mask, ptr)
+	#define avx512_store(ptr, mask, a) _mm512_mask_store_pd(ptr, mask, a)
+	#define avx512_set1(a) _mm512_set1_pd(a)
+	#define avx512_fmadd(a, b, c) _mm512_fmadd_pd(a, b, c) // a * b + c
+	#define avx512_fnmadd(a, b, c) _mm512_fnmadd_pd(a, b, c) // -(a * b) + c
+#endif
+
+void commutator_omp_manual_aosoa_constants_direct_perm_avx512(real_vec_t const* restrict sigma_in_vec,
+                                                              real_vec_t* restrict sigma_out_vec,
+                                                              real_t const* restrict hamiltonian,
+                                                              const int num, const int dim,
+                                                              const real_t hbar, const real_t dt)
+{
+	real_t const* restrict sigma_in = reinterpret_cast<real_t const*>(sigma_in_vec);
+	real_t* restrict sigma_out = reinterpret_cast<real_t*>(sigma_out_vec);
+
+	const int num_packages = (num + VEC_LENGTH - 1) / VEC_LENGTH;
+	const int tail = num % VEC_LENGTH; // active lanes of the last package, 0 if full
+	const avx512_mask_t full_mask = static_cast<avx512_mask_t>(~0);
+
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	for (int global_id = 0; global_id < num_packages; ++global_id)
+	{
+		const avx512_mask_t mask = (tail && global_id == num_packages - 1)
+		                         ? static_cast<avx512_mask_t>((1 << tail) - 1) : full_mask;
+
+		#define package_id (global_id * DIM * DIM * 2 * VEC_LENGTH)
+
+		#define sigma_real(i, j) (package_id + 2 * VEC_LENGTH * (DIM * i + j))
+		#define sigma_imag(i, j) (package_id + 2 * VEC_LENGTH * (DIM * i + j) + VEC_LENGTH)
+
+		#define ham_real(i, j) (i * DIM + j)
+		#define ham_imag(i, j) (DIM * DIM + i * DIM + j)
+
+		// compute commutator: (hamiltonian * sigma_in[sigma_id] - sigma_in[sigma_id] * hamiltonian)
+		for (int i = 0; i < DIM; ++i)
+		{
+			avx512_vec_t out_real[DIM];
+			avx512_vec_t out_imag[DIM];
+			for (int j = 0; j < DIM; ++j)
+			{
+				out_real[j] = avx512_load(mask, sigma_out + sigma_real(i, j));
+				out_imag[j] = avx512_load(mask, sigma_out + sigma_imag(i, j));
+			}
+
+			for (int k = 0; k < DIM; ++k)
+			{
+				const avx512_vec_t ham_real_ik = avx512_set1(hamiltonian[ham_real(i, k)]);
+				const avx512_vec_t ham_imag_ik = avx512_set1(hamiltonian[ham_imag(i, k)]);
+				const avx512_vec_t sigma_real_ik = avx512_load(mask, sigma_in + sigma_real(i, k));
+				const avx512_vec_t sigma_imag_ik = avx512_load(mask, sigma_in + sigma_imag(i, k));
+				for (int j = 0; j < DIM; ++j)
+				{
+					const avx512_vec_t ham_real_kj = avx512_set1(hamiltonian[ham_real(k, j)]);
+					const avx512_vec_t ham_imag_kj = avx512_set1(hamiltonian[ham_imag(k, j)]);
+					const avx512_vec_t sigma_real_kj = avx512_load(mask, sigma_in + sigma_real(k, j));
+					const avx512_vec_t sigma_imag_kj = avx512_load(mask, sigma_in + sigma_imag(k, j));
+
+					out_imag[j] = avx512_fnmadd(sigma_real_kj, ham_real_ik, out_imag[j]);
+					out_imag[j] = avx512_fmadd(sigma_real_ik, ham_real_kj, out_imag[j]);
+					out_imag[j] = avx512_fmadd(sigma_imag_kj, ham_imag_ik, out_imag[j]);
+					out_imag[j] = avx512_fnmadd(sigma_imag_ik, ham_imag_kj, out_imag[j]);
+					out_real[j] = avx512_fmadd(sigma_imag_kj, ham_real_ik, out_real[j]);
+					out_real[j] = avx512_fnmadd(sigma_real_ik, ham_imag_kj, out_real[j]);
+					out_real[j] = avx512_fmadd(sigma_real_kj, ham_imag_ik, out_real[j]);
+					out_real[j] = avx512_fnmadd(sigma_imag_ik, ham_real_kj, out_real[j]);
+				}
+			}
+
+			for (int j = 0; j < DIM; ++j)
+			{
+				avx512_store(sigma_out + sigma_real(i, j), mask, out_real[j]);
+				avx512_store(sigma_out + sigma_imag(i, j), mask, out_imag[j]);
+			}
+		}
+
+		#undef package_id
+		#undef sigma_real
+		#undef sigma_imag
+		#undef ham_real
+		#undef ham_imag
+	}
+}
+
+#undef avx512_load
+#undef avx512_store
+#undef avx512_set1
+#undef avx512_fmadd
+#undef avx512_fnmadd
+
+#endif // HOST_AVX512
@@ -0,0 +1,42 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+// NOTE: sigma is expected in the eigenbasis of the Hamiltonian, see
+//       basis_transform_omp_manual_aosoa_constants(), and hamiltonian points
+//       to its DIM (pre-scaled) eigenvalues E, the commutator reduces to:
+//       [H, sigma](i, j) = (E(i) - E(j)) * sigma(i, j)
+void commutator_omp_manual_aosoa_constants_eigenbasis(real_vec_t const* restrict sigma_in, 
+                                                      real_vec_t* restrict sigma_out, 
+                                                      real_t const* restrict hamiltonian, 
+                                                      const int num, const int dim,
+                                                      const real_t hbar, const real_t dt)
+{
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+	for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+	{
+		#define package_id (global_id * DIM * DIM * 2)
+
+		#define sigma_real(i, j) (package_id + 2 * (DIM * (i) + (j)))
+		#define sigma_imag(i, j) (package_id + 2 * (DIM * (i) + (j)) + 1)
+
+		#define eigenvalue(i) (i)
+
+		// compute commutator: -i * (E(i) - E(j)) * sigma_in(i, j)
+		int i, j;
+		for (i = 0; i < DIM; ++i)
+		{
+			for (j = 0; j < DIM; ++j)
+			{
+				real_t e_diff = hamiltonian[eigenvalue(i)] - hamiltonian[eigenvalue(j)];
+				sigma_out[sigma_real(i, j)] += sigma_in[sigma_imag(i, j)] * e_diff;
+				sigma_out[sigma_imag(i, j)] -= sigma_in[sigma_real(i, j)] * e_diff;
+			}
+		}
+	}
+}
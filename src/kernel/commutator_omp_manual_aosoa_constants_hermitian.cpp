@@ -0,0 +1,87 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+// NOTE: sigma uses the packed Hermitian layout of
+//       transform_matrices_aos_to_aosoa_hermitian(), the Hamiltonian must be
+//       Hermitian, so that the result is Hermitian as well and only the upper
+//       triangle (i <= j) needs to be computed
+void commutator_omp_manual_aosoa_constants_hermitian(real_vec_t const* restrict sigma_in, 
+                                                     real_vec_t* restrict sigma_out, 
+                                                     real_t const* restrict hamiltonian, 
+                                                     const int num, const int dim,
+                                                     const real_t hbar, const real_t dt)
+{
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+	for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+	{
+		// original OpenCL kernel begins here
+		#define package_id (global_id * DIM * DIM)
+
+		// packed upper triangle, row by row
+		#define offdiag_id(i, j) ((i) * (2 * DIM - (i) - 1) / 2 + (j) - (i) - 1)
+		#define sigma_diag(i) (package_id + (i))
+		#define sigma_real(i, j) (package_id + DIM + 2 * offdiag_id(i, j))
+		#define sigma_imag(i, j) (package_id + DIM + 2 * offdiag_id(i, j) + 1)
+
+		// access to any element of the full matrix, imaginary parts need to be
+		// multiplied with conj_sign(i, j), and are zero for i == j
+		#define sigma_full_real(i, j) ((i) == (j) ? sigma_diag(i) : ((i) < (j) ? sigma_real(i, j) : sigma_real(j, i)))
+		#define sigma_full_imag(i, j) ((i) < (j) ? sigma_imag(i, j) : sigma_imag(j, i))
+		#define conj_sign(i, j) ((i) < (j) ? real_t(1.0) : real_t(-1.0))
+
+		#define ham_real(i, j) ((i) * DIM + (j))
+		#define ham_imag(i, j) (DIM * DIM + (i) * DIM + (j))
+
+		// compute commutator: (hamiltonian * sigma_in[sigma_id] - sigma_in[sigma_id] * hamiltonian)
+		int i, j, k;
+		for (i = 0; i < DIM; ++i)
+		{
+			// diagonal: the commutator is purely imaginary here, i.e. only the
+			// real part of sigma_out changes
+			real_vec_t tmp_diag = sigma_out[sigma_diag(i)];
+			for (k = 0; k < DIM; ++k)
+			{
+				tmp_diag += sigma_in[sigma_full_real(k, i)] * hamiltonian[ham_imag(i, k)];
+				tmp_diag -= sigma_in[sigma_full_real(i, k)] * hamiltonian[ham_imag(k, i)];
+				if (k != i)
+				{
+					tmp_diag += sigma_in[sigma_full_imag(k, i)] * (conj_sign(k, i) * hamiltonian[ham_real(i, k)]);
+					tmp_diag -= sigma_in[sigma_full_imag(i, k)] * (conj_sign(i, k) * hamiltonian[ham_real(k, i)]);
+				}
+			}
+			sigma_out[sigma_diag(i)] = tmp_diag;
+
+			// strict upper triangle
+			for (j = i + 1; j < DIM; ++j)
+			{
+				real_vec_t tmp_real = sigma_out[sigma_real(i, j)];
+				real_vec_t tmp_imag = sigma_out[sigma_imag(i, j)];
+				for (k = 0; k < DIM; ++k)
+				{
+					tmp_imag -= sigma_in[sigma_full_real(k, j)] * hamiltonian[ham_real(i, k)];
+					tmp_imag += sigma_in[sigma_full_real(i, k)] * hamiltonian[ham_real(k, j)];
+					tmp_real += sigma_in[sigma_full_real(k, j)] * hamiltonian[ham_imag(i, k)];
+					tmp_real -= sigma_in[sigma_full_real(i, k)] * hamiltonian[ham_imag(k, j)];
+					if (k != j)
+					{
+						tmp_imag += sigma_in[sigma_full_imag(k, j)] * (conj_sign(k, j) * hamiltonian[ham_imag(i, k)]);
+						tmp_real += sigma_in[sigma_full_imag(k, j)] * (conj_sign(k, j) * hamiltonian[ham_real(i, k)]);
+					}
+					if (k != i)
+					{
+						tmp_imag -= sigma_in[sigma_full_imag(i, k)] * (conj_sign(i, k) * hamiltonian[ham_imag(k, j)]);
+						tmp_real -= sigma_in[sigma_full_imag(i, k)] * (conj_sign(i, k) * hamiltonian[ham_real(k, j)]);
+					}
+				}
+				sigma_out[sigma_real(i, j)] = tmp_real;
+				sigma_out[sigma_imag(i, j)] = tmp_imag;
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+// Lindblad equation in one sweep over sigma:
+//     sigma_out += -i (A sigma - sigma A^H) + sum_l L_l sigma L_l^H
+// A = H - i dt / 2 sum_l L_l^H L_l contains the anti-commutator, both A and
+// A^H are stored (transform_matrix_aos_to_soa_lindblad), the L_l are
+// pre-scaled by sqrt(dt)
+void commutator_omp_manual_aosoa_constants_lindblad(real_vec_t const* restrict sigma_in,
+                                                    real_vec_t* restrict sigma_out,
+                                                    real_t const* restrict hamiltonian,
+                                                    const int num, const int dim,
+                                                    const real_t hbar, const real_t dt,
+                                                    real_t const* restrict jump_operators)
+{
+	// OpenCL work-groups are mapped to threads
+	#pragma omp parallel for
+	#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+	for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+	{
+		// original OpenCL kernel begins here
+		#define package_id (global_id * DIM * DIM * 2)
+
+		#define sigma_real(i, j) (package_id + 2 * (DIM * (i) + (j)))
+		#define sigma_imag(i, j) (package_id + 2 * (DIM * (i) + (j)) + 1)
+		#define tmp_id(i, j) (DIM * (i) + (j))
+
+		#define ham_real(i, j) ((i) * DIM + (j))
+		#define ham_imag(i, j) (DIM * DIM + (i) * DIM + (j))
+		#define ham_adjoint_real(i, j) (2 * DIM * DIM + (i) * DIM + (j))
+		#define ham_adjoint_imag(i, j) (3 * DIM * DIM + (i) * DIM + (j))
+
+		#define jump_real(l, i, j) (2 * DIM * DIM * (l) + (i) * DIM + (j))
+		#define jump_imag(l, i, j) (2 * DIM * DIM * (l) + DIM * DIM + (i) * DIM + (j))
+
+		// coherent part and anti-commutator: -i (A * sigma - sigma * A^H)
+		int i, j, k, l;
+		for (i = 0; i < DIM; ++i)
+		{
+			for (k = 0; k < DIM; ++k)
+			{
+				real_t ham_real_tmp = hamiltonian[ham_real(i, k)];
+				real_t ham_imag_tmp = hamiltonian[ham_imag(i, k)];
+				real_vec_t sigma_real_tmp = sigma_in[sigma_real(i, k)];
+				real_vec_t sigma_imag_tmp = sigma_in[sigma_imag(i, k)];
+				for (j = 0; j < DIM; ++j)
+				{
+					// reordered operands (there is no scalar-times-vector operator in micvec.h)
+					sigma_out[sigma_imag(i, j)] -= sigma_in[sigma_real(k, j)] * ham_real_tmp;
+					sigma_out[sigma_imag(i, j)] += sigma_real_tmp * hamiltonian[ham_adjoint_real(k, j)];
+					sigma_out[sigma_imag(i, j)] += sigma_in[sigma_imag(k, j)] * ham_imag_tmp;
+					sigma_out[sigma_imag(i, j)] -= sigma_imag_tmp * hamiltonian[ham_adjoint_imag(k, j)];
+					sigma_out[sigma_real(i, j)] += sigma_in[sigma_imag(k, j)] * ham_real_tmp;
+					sigma_out[sigma_real(i, j)] -= sigma_real_tmp * hamiltonian[ham_adjoint_imag(k, j)];
+					sigma_out[sigma_real(i, j)] += sigma_in[sigma_real(k, j)] * ham_imag_tmp;
+					sigma_out[sigma_real(i, j)] -= sigma_imag_tmp * hamiltonian[ham_adjoint_real(k, j)];
+				}
+			}
+		}
+
+		// jump terms: L_l * sigma * L_l^H, compile-time number of operators
+		for (l = 0; l < NUM_JUMP_OPS; ++l)
+		{
+			// tmp = L_l * sigma
+			real_vec_t tmp_real[DIM * DIM];
+			real_vec_t tmp_imag[DIM * DIM];
+			for (i = 0; i < DIM * DIM; ++i)
+			{
+				tmp_real[i] = real_vec_t(real_t(0.0));
+				tmp_imag[i] = real_vec_t(real_t(0.0));
+			}
+			for (i = 0; i < DIM; ++i)
+			{
+				for (k = 0; k < DIM; ++k)
+				{
+					real_t jump_real_tmp = jump_operators[jump_real(l, i, k)];
+					real_t jump_imag_tmp = jump_operators[jump_imag(l, i, k)];
+					for (j = 0; j < DIM; ++j)
+					{
+						tmp_real[tmp_id(i, j)] += sigma_in[sigma_real(k, j)] * jump_real_tmp;
+						tmp_real[tmp_id(i, j)] -= sigma_in[sigma_imag(k, j)] * jump_imag_tmp;
+						tmp_imag[tmp_id(i, j)] += sigma_in[sigma_imag(k, j)] * jump_real_tmp;
+						tmp_imag[tmp_id(i, j)] += sigma_in[sigma_real(k, j)] * jump_imag_tmp;
+					}
+				}
+			}
+			// sigma_out += tmp * L_l^H, i.e. tmp_ik * conj(L_jk)
+			for (i = 0; i < DIM; ++i)
+			{
+				for (j = 0; j < DIM; ++j)
+				{
+					real_vec_t out_real(real_t(0.0));
+					real_vec_t out_imag(real_t(0.0));
+					for (k = 0; k < DIM; ++k)
+					{
+						out_real += tmp_real[tmp_id(i, k)] * jump_operators[jump_real(l, j, k)];
+						out_real += tmp_imag[tmp_id(i, k)] * jump_operators[jump_imag(l, j, k)];
+						out_imag += tmp_imag[tmp_id(i, k)] * jump_operators[jump_real(l, j, k)];
+						out_imag -= tmp_real[tmp_id(i, k)] * jump_operators[jump_imag(l, j, k)];
+					}
+					sigma_out[sigma_real(i, j)] += out_real;
+					sigma_out[sigma_imag(i, j)] += out_imag;
+				}
+			}
+		}
+
+		#undef package_id
+		#undef sigma_real
+		#undef sigma_imag
+		#undef tmp_id
+		#undef ham_real
+		#undef ham_imag
+		#undef ham_adjoint_real
+		#undef ham_adjoint_imag
+		#undef jump_real
+		#undef jump_imag
+	}
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+#include "kernel/commutator_template.hpp"
+
+using commutator_template_function = void (*)(real_vec_t const* restrict, real_vec_t* restrict, real_t const* restrict, const int);
+
+static const int template_dims[] = { TEMPLATE_DIMS };
+
+// one instantiation of commutator_aosoa per Dim in TEMPLATE_DIMS
+template<int... Dims>
+static commutator_template_function lookup_commutator_aosoa(int dim, std::integer_sequence<int, Dims...>)
+{
+	static const commutator_template_function table[] = { &commutator_aosoa<Dims, real_vec_t>... };
+	for (size_t i = 0; i < sizeof...(Dims); ++i)
+		if (template_dims[i] == dim)
+			return table[i];
+	return nullptr;
+}
+
+void commutator_omp_manual_aosoa_template(real_vec_t const* restrict sigma_in,
+                                          real_vec_t* restrict sigma_out,
+                                          real_t const* restrict hamiltonian,
+                                          const int num, const int dim,
+                                          const real_t hbar, const real_t dt)
+{
+	auto kernel = lookup_commutator_aosoa(dim, std::integer_sequence<int, TEMPLATE_DIMS>());
+	if (!kernel)
+	{
+		std::cerr << "Error: commutator_omp_manual_aosoa_template: dim " << dim << " is not in TEMPLATE_DIMS:";
+		for (int d : template_dims)
+			std::cerr << " " << d;
+		std::cerr << std::endl;
+		return;
+	}
+
+	kernel(sigma_in, sigma_out, hamiltonian, num);
+}
@@ -36,3 +36,111 @@ void commutator_reference(complex_t* sigma_in, complex_t* sigma_out, complex_t*
 	}
 }
 
+// same as commutator_reference, but with one hamiltonian per sigma matrix
+void commutator_reference_batched(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonians, size_t dim, size_t num_sigma, real_t hbar, real_t dt)
+{
+	const size_t size_sigma = dim * dim;
+	real_t hdt = dt / hbar;
+
+	// iterate over all sigma matrices
+	#pragma omp parallel for
+	for (size_t n = 0; n < num_sigma; ++n)
+	{
+		size_t sigma_id = n * size_sigma;
+		complex_t const* hamiltonian = hamiltonians + sigma_id;
+		// compute commutator term: i * dt / hbar * (hamiltonian * sigma - sigma * hamiltonian)
+		for (size_t i = 0; i < dim; ++i)
+		{
+			for (size_t j = 0; j < dim; ++j)
+			{
+				complex_t tmp = 0.0;
+				for (size_t k = 0; k < dim; ++k)
+				{
+					tmp += hamiltonian[i * dim + k] * sigma_in[sigma_id + k * dim + j]
+					     - sigma_in[sigma_id + i * dim + k] * hamiltonian[k * dim + j];
+				}
+				sigma_out[sigma_id + i * dim + j] -= complex_t(0.0,1.0) * hdt * tmp;
+			}
+		}
+	}
+}
+
+
+// same as commutator_reference, with the hamiltonian (hamiltonian + field * dipole)
+void commutator_reference_field(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, complex_t* dipole, real_t field)
+{
+	const size_t size_hamiltonian = dim * dim;
+	complex_t* hamiltonian_field = new complex_t[size_hamiltonian];
+	for (size_t i = 0; i < size_hamiltonian; ++i)
+		hamiltonian_field[i] = hamiltonian[i] + field * dipole[i];
+
+	commutator_reference(sigma_in, sigma_out, hamiltonian_field, dim, num_sigma, hbar, dt);
+
+	delete[] hamiltonian_field;
+}
+
+// commutator_reference plus the Lindblad dissipator of num_jump_operators jump
+// operators L_l (AoS, one after another):
+// dt * sum_l (L_l * sigma * L_l^H - 1/2 * (L_l^H L_l * sigma + sigma * L_l^H L_l))
+void commutator_reference_lindblad(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, complex_t* jump_operators, size_t num_jump_operators)
+{
+	const size_t size_sigma = dim * dim;
+
+	commutator_reference(sigma_in, sigma_out, hamiltonian, dim, num_sigma, hbar, dt);
+
+	// L_l^H L_l
+	complex_t* jump_products = new complex_t[num_jump_operators * size_sigma];
+	for (size_t l = 0; l < num_jump_operators; ++l)
+	{
+		complex_t* jump_operator = jump_operators + l * size_sigma;
+		for (size_t i = 0; i < dim; ++i)
+			for (size_t j = 0; j < dim; ++j)
+			{
+				complex_t tmp = 0.0;
+				for (size_t k = 0; k < dim; ++k)
+					tmp += std::conj(jump_operator[k * dim + i]) * jump_operator[k * dim + j];
+				jump_products[l * size_sigma + i * dim + j] = tmp;
+			}
+	}
+
+	// iterate over all sigma matrices
+	#pragma omp parallel for
+	for (size_t n = 0; n < num_sigma; ++n)
+	{
+		size_t sigma_id = n * size_sigma;
+		complex_t* jump_sigma = new complex_t[size_sigma];
+		for (size_t l = 0; l < num_jump_operators; ++l)
+		{
+			complex_t* jump_operator = jump_operators + l * size_sigma;
+			complex_t* jump_product = jump_products + l * size_sigma;
+			// L * sigma
+			for (size_t i = 0; i < dim; ++i)
+				for (size_t j = 0; j < dim; ++j)
+				{
+					complex_t tmp = 0.0;
+					for (size_t k = 0; k < dim; ++k)
+						tmp += jump_operator[i * dim + k] * sigma_in[sigma_id + k * dim + j];
+					jump_sigma[i * dim + j] = tmp;
+				}
+			for (size_t i = 0; i < dim; ++i)
+			{
+				for (size_t j = 0; j < dim; ++j)
+				{
+					complex_t tmp = 0.0;
+					for (size_t k = 0; k < dim; ++k)
+					{
+						// L * sigma * L^H
+						tmp += jump_sigma[i * dim + k] * std::conj(jump_operator[j * dim + k]);
+						// - 1/2 {L^H L, sigma}
+						tmp -= real_t(0.5) * (jump_product[i * dim + k] * sigma_in[sigma_id + k * dim + j]
+						                    + sigma_in[sigma_id + i * dim + k] * jump_product[k * dim + j]);
+					}
+					sigma_out[sigma_id + i * dim + j] += dt * tmp;
+				}
+			}
+		}
+		delete[] jump_sigma;
+	}
+
+	delete[] jump_products;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+#include "kernel/commutator_package.hpp"
+
+// HEOM right-hand side (see heom.hpp) for all members of all hierarchies in
+// one sweep: package p is member p % num_members, all vector lanes of a
+// package share the hierarchy structure, i.e. the neighbours are gathered per
+// package via the index table and the coefficients are scalars
+// NOTE: with projectors V_k = |s><s| the coupling only touches row and column s
+void heom_omp_manual_aosoa_constants(real_vec_t const* restrict sigma_in,
+                                     real_vec_t* restrict sigma_out,
+                                     real_t const* restrict hamiltonian,
+                                     const int num, const int dim,
+                                     int const* restrict neighbour,
+                                     real_t const* restrict coupling,
+                                     real_t const* restrict damping,
+                                     int const* restrict site,
+                                     const int num_members, const int num_modes)
+{
+	#pragma omp parallel for
+	for (int package_id = 0; package_id < (num / VEC_LENGTH); ++package_id)
+	{
+		const int member = package_id % num_members;
+		const int first_package = package_id - member; // of this hierarchy
+
+		real_vec_t const* restrict in = sigma_in + package_id * PACKAGE_SIZE;
+		real_vec_t* restrict out = sigma_out + package_id * PACKAGE_SIZE;
+
+		#define sigma_real(i, j) (2 * (DIM * (i) + (j)))
+		#define sigma_imag(i, j) (2 * (DIM * (i) + (j)) + 1)
+
+		// -i * [hamiltonian, sigma_n] - damping_n * sigma_n
+		commutator_package(in, out, hamiltonian);
+		axpy_package(-damping[member], in, out);
+
+		// gather the neighbours
+		for (int mode = 0; mode < num_modes; ++mode)
+		{
+			int const* restrict neighbour_tmp = neighbour + (member * num_modes + mode) * 2;
+			real_t const* restrict coupling_tmp = coupling + (member * num_modes + mode) * 3;
+			real_vec_t const* restrict up = sigma_in + (first_package + neighbour_tmp[0]) * PACKAGE_SIZE;
+			real_vec_t const* restrict down = sigma_in + (first_package + neighbour_tmp[1]) * PACKAGE_SIZE;
+			const real_t up_coupling = coupling_tmp[0];
+			const real_t down_real = coupling_tmp[1];
+			const real_t down_imag = coupling_tmp[2];
+			const int s = site[mode];
+
+			for (int j = 0; j < DIM; ++j)
+			{
+				// row s: -i * (up_coupling * up_sj + down_coupling * down_sj)
+				real_vec_t sum_real = up[sigma_real(s, j)] * up_coupling
+				                    + down[sigma_real(s, j)] * down_real
+				                    - down[sigma_imag(s, j)] * down_imag;
+				real_vec_t sum_imag = up[sigma_imag(s, j)] * up_coupling
+				                    + down[sigma_imag(s, j)] * down_real
+				                    + down[sigma_real(s, j)] * down_imag;
+				out[sigma_real(s, j)] += sum_imag;
+				out[sigma_imag(s, j)] -= sum_real;
+
+				// column s: i * (up_coupling * up_js + conj(down_coupling) * down_js)
+				sum_real = up[sigma_real(j, s)] * up_coupling
+				         + down[sigma_real(j, s)] * down_real
+				         + down[sigma_imag(j, s)] * down_imag;
+				sum_imag = up[sigma_imag(j, s)] * up_coupling
+				         + down[sigma_imag(j, s)] * down_real
+				         - down[sigma_real(j, s)] * down_imag;
+				out[sigma_real(j, s)] -= sum_imag;
+				out[sigma_imag(j, s)] += sum_real;
+			}
+		}
+
+		#undef sigma_real
+		#undef sigma_imag
+	}
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+#include "heom.hpp"
+
+// unoptimised/readable reference implementation for correctness validation,
+// sigma holds whole hierarchies in the order of the AoSoA kernels: package p
+// is member p % num_members of a hierarchy, the vec_length matrices of a
+// package belong to vec_length independent systems
+void heom_reference(complex_t* sigma_in, complex_t* sigma_out, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt,
+                    heom_hierarchy const& hierarchy, size_t vec_length)
+{
+	const size_t size_sigma = dim * dim;
+	const int num_modes = hierarchy.num_modes;
+	real_t hdt = dt / hbar;
+
+	// iterate over all sigma matrices
+	#pragma omp parallel for
+	for (size_t n = 0; n < num_sigma; ++n)
+	{
+		const size_t package = n / vec_length;
+		const size_t lane = n % vec_length;
+		const int member = package % hierarchy.num_members;
+		const size_t first_package = package - member; // of this hierarchy
+
+		complex_t const* in = sigma_in + n * size_sigma;
+		complex_t* out = sigma_out + n * size_sigma;
+
+		// -i * dt / hbar * (hamiltonian * sigma - sigma * hamiltonian) - damping * sigma
+		for (size_t i = 0; i < dim; ++i)
+		{
+			for (size_t j = 0; j < dim; ++j)
+			{
+				complex_t tmp = 0.0;
+				for (size_t k = 0; k < dim; ++k)
+				{
+					tmp += hamiltonian[i * dim + k] * in[k * dim + j]
+					     - in[i * dim + k] * hamiltonian[k * dim + j];
+				}
+				out[i * dim + j] -= complex_t(0.0, 1.0) * hdt * tmp;
+				out[i * dim + j] -= hierarchy.damping[member] * in[i * dim + j];
+			}
+		}
+
+		// coupling to the neighbours
+		for (int mode = 0; mode < num_modes; ++mode)
+		{
+			int const* neighbour = hierarchy.neighbour + (member * num_modes + mode) * 2;
+			real_t const* coupling = hierarchy.coupling + (member * num_modes + mode) * 3;
+			const size_t s = hierarchy.site[mode];
+
+			complex_t const* up = sigma_in + ((first_package + neighbour[0]) * vec_length + lane) * size_sigma;
+			complex_t const* down = sigma_in + ((first_package + neighbour[1]) * vec_length + lane) * size_sigma;
+			const complex_t up_coupling(coupling[0], 0.0);
+			const complex_t down_coupling(coupling[1], coupling[2]);
+
+			for (size_t i = 0; i < dim; ++i)
+			{
+				for (size_t j = 0; j < dim; ++j)
+				{
+					// V sigma and sigma V with the projector V = |s><s|
+					complex_t v_up = ((i == s) ? up[s * dim + j] : complex_t(0.0)) - ((j == s) ? up[i * dim + s] : complex_t(0.0));
+					complex_t v_down_left = (i == s) ? down[s * dim + j] : complex_t(0.0);
+					complex_t v_down_right = (j == s) ? down[i * dim + s] : complex_t(0.0);
+					out[i * dim + j] -= complex_t(0.0, 1.0) * (up_coupling * v_up
+					                                           + down_coupling * v_down_left
+					                                           - std::conj(down_coupling) * v_down_right);
+				}
+			}
+		}
+	}
+}
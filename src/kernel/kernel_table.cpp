@@ -0,0 +1,65 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// NOTE: compiled once per ISA level by make_omp.sh -m, with
+//       -DKERNEL_ISA=<isa> -DKERNEL_TABLE=kernel_table_<isa> and every kernel
+//       name defined to <name>_isa_<isa>
+
+#include "common.hpp"
+#include "kernel/kernel.hpp"
+#include "kernel/kernel_table.hpp"
+
+#if !defined(KERNEL_ISA) || !defined(KERNEL_TABLE)
+	#error "KERNEL_ISA and KERNEL_TABLE must be defined, see make_omp.sh -m"
+#endif
+
+// NOTE: #name is not macro-expanded, i.e. the entry name has no ISA suffix
+#define SCALAR_KERNEL(name, real_hamiltonian_only) \
+	{ #name, [](KERNEL_TABLE_PARAMETERS) { name(sigma_in, sigma_out, hamiltonian, num, dim, hbar, dt); }, real_hamiltonian_only, false, \
+	  &transform_matrices_aos_to_aosoa, &transform_matrix_aos_to_soa }
+
+#define VECTOR_KERNEL_LAYOUT(name, real_hamiltonian_only, hermitian_only, transformation_sigma, transformation_hamiltonian) \
+	{ #name, [](KERNEL_TABLE_PARAMETERS) { name(reinterpret_cast<real_vec_t const*>(sigma_in), reinterpret_cast<real_vec_t*>(sigma_out), hamiltonian, num, dim, hbar, dt); }, real_hamiltonian_only, hermitian_only, \
+	  transformation_sigma, transformation_hamiltonian }
+
+#define VECTOR_KERNEL(name, real_hamiltonian_only) \
+	{ #name, [](KERNEL_TABLE_PARAMETERS) { name(reinterpret_cast<real_vec_t const*>(sigma_in), reinterpret_cast<real_vec_t*>(sigma_out), hamiltonian, num, dim, hbar, dt); }, real_hamiltonian_only, false, \
+	  &transform_matrices_aos_to_aosoa, &transform_matrix_aos_to_soa }
+
+// all commutator kernels with the common signature, i.e. the ones of
+// benchmark_omp that do not need additional operators or a basis change
+static const kernel_table_entry kernels[] = {
+	// auto:
+	SCALAR_KERNEL(commutator_omp_aosoa, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_constants, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_direct, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_constants_direct, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_constants_direct_perm, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_constants_direct_perm2to3, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_constants_direct_perm2to5, false),
+	SCALAR_KERNEL(commutator_omp_aosoa_constants_direct_perm_realham, true),
+	// manual:
+	VECTOR_KERNEL(commutator_omp_manual_aosoa, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_perm, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_direct, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_direct, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_direct_perm, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_direct_unrollhints, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_direct_perm_unrollhints, false),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_direct_perm_realham, true),
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_template, false),
+	VECTOR_KERNEL_LAYOUT(commutator_omp_manual_aosoa_constants_3m, false, false, &transform_matrices_aos_to_aosoa, &transform_matrix_aos_to_soa_3m),
+	VECTOR_KERNEL_LAYOUT(commutator_omp_manual_aosoa_constants_hermitian, false, true, &transform_matrices_aos_to_aosoa_hermitian, &transform_matrix_aos_to_soa),
+#ifdef HOST_AVX512
+	VECTOR_KERNEL(commutator_omp_manual_aosoa_constants_direct_perm_avx512, false),
+#endif
+};
+
+#undef SCALAR_KERNEL
+#undef VECTOR_KERNEL_LAYOUT
+#undef VECTOR_KERNEL
+
+const kernel_table KERNEL_TABLE = { STR(KERNEL_ISA), VEC_LENGTH, kernels, sizeof(kernels) / sizeof(kernels[0]) };
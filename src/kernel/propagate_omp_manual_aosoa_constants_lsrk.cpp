@@ -0,0 +1,31 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+#include "kernel/commutator_package.hpp"
+
+// 2N-storage low-storage Runge-Kutta, 5 stages, 4th order (Carpenter and
+// Kennedy, 1994) for d/dt sigma = -i / hbar * [H, sigma], with the Hamiltonian
+// pre-scaled by dt / hbar:
+//     dq = A[s] * dq + f(sigma)
+//     sigma = sigma + B[s] * dq
+// NOTE: one sweep over sigma per time step, all five stages are fused per
+//       package, see lsrk_step_package()
+void propagate_omp_manual_aosoa_constants_lsrk(real_vec_t* restrict sigma,
+                                               real_t const* restrict hamiltonian,
+                                               const int num, const int dim,
+                                               const int num_steps)
+{
+	for (int step = 0; step < num_steps; ++step)
+	{
+		// OpenCL work-groups are mapped to threads
+		#pragma omp parallel for
+		#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+		for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+		{
+			lsrk_step_package(sigma + global_id * PACKAGE_SIZE, hamiltonian);
+		}
+	}
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm> // min
+
+#include "common.hpp"
+#include "kernel/commutator_package.hpp"
+
+// temporally blocked low-storage Runge-Kutta, see propagate_omp_manual_aosoa_constants_lsrk()
+// NOTE: the packages are independent for a shared Hamiltonian, so each one is
+//       copied into a local buffer and advanced by time_block steps before it
+//       is written back, i.e. one sweep over sigma per time_block steps
+void propagate_omp_manual_aosoa_constants_lsrk_blocked(real_vec_t* restrict sigma,
+                                                       real_t const* restrict hamiltonian,
+                                                       const int num, const int dim,
+                                                       const int num_steps, const int time_block)
+{
+	if (time_block < 1)
+	{
+		std::cerr << "Error: propagate_omp_manual_aosoa_constants_lsrk_blocked: time_block " << time_block << " is not positive" << std::endl;
+		return;
+	}
+
+	for (int step = 0; step < num_steps; step += time_block)
+	{
+		const int block_steps = std::min(time_block, num_steps - step);
+
+		// OpenCL work-groups are mapped to threads
+		#pragma omp parallel for
+		#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+		for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+		{
+			real_vec_t package[PACKAGE_SIZE];
+			copy_package(sigma + global_id * PACKAGE_SIZE, package);
+			for (int t = 0; t < block_steps; ++t)
+				lsrk_step_package(package, hamiltonian);
+			copy_package(package, sigma + global_id * PACKAGE_SIZE);
+		}
+	}
+}
@@ -0,0 +1,28 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+#include "kernel/commutator_package.hpp"
+
+// classical 4th order Runge-Kutta for d/dt sigma = -i / hbar * [H, sigma],
+// with the Hamiltonian pre-scaled by dt / hbar
+// NOTE: one sweep over sigma per time step, all four stages are fused per
+//       package, see rk4_step_package()
+void propagate_omp_manual_aosoa_constants_rk4(real_vec_t* restrict sigma,
+                                              real_t const* restrict hamiltonian,
+                                              const int num, const int dim,
+                                              const int num_steps)
+{
+	for (int step = 0; step < num_steps; ++step)
+	{
+		// OpenCL work-groups are mapped to threads
+		#pragma omp parallel for
+		#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+		for (int global_id = 0; global_id < (num / VEC_LENGTH); ++global_id)
+		{
+			rk4_step_package(sigma + global_id * PACKAGE_SIZE, hamiltonian);
+		}
+	}
+}
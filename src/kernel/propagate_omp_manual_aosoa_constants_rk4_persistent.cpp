@@ -0,0 +1,52 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <omp.h>
+
+#include "common.hpp"
+#include "schedule.hpp" // sense_barrier
+#include "kernel/commutator_package.hpp"
+
+// classical 4th order Runge-Kutta, see propagate_omp_manual_aosoa_constants_rk4()
+// NOTE: one parallel region for all num_steps instead of one per step, each
+//       thread owns the same contiguous slice of packages for the whole run
+//       (as schedule(static), i.e. NUMA-local after a parallel first touch)
+// NOTE: the packages are independent for a shared Hamiltonian, synchronise == 0
+//       lets every thread run through all steps on its own, otherwise the
+//       threads meet at a sense-reversing barrier after each step (as needed
+//       when a step reads other packages or the Hamiltonian changes per step)
+void propagate_omp_manual_aosoa_constants_rk4_persistent(real_vec_t* restrict sigma,
+                                                         real_t const* restrict hamiltonian,
+                                                         const int num, const int dim,
+                                                         const int num_steps, const int synchronise)
+{
+	const int num_packages = num / VEC_LENGTH;
+	sense_barrier barrier;
+
+	#pragma omp parallel
+	{
+		#pragma omp single
+		barrier.reset(omp_get_num_threads());
+		// implicit barrier of single
+
+		const int thread = omp_get_thread_num();
+		const int num_threads = omp_get_num_threads();
+		const int first = (static_cast<long>(num_packages) * thread) / num_threads;
+		const int last = (static_cast<long>(num_packages) * (thread + 1)) / num_threads;
+		bool local_sense = false;
+
+		for (int step = 0; step < num_steps; ++step)
+		{
+			#pragma novector // NOTE: we do not want any implicit vectorisation in this kernel
+			for (int global_id = first; global_id < last; ++global_id)
+			{
+				rk4_step_package(sigma + global_id * PACKAGE_SIZE, hamiltonian);
+			}
+
+			if (synchronise)
+				barrier.wait(local_sense);
+		}
+	}
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "common.hpp"
+
+#include <algorithm> // fill
+#include <vector>
+
+// out += -i * dt / hbar * (hamiltonian * in - in * hamiltonian), for a single matrix
+static void commutator_matrix_reference(complex_t const* in, complex_t* out, complex_t const* hamiltonian, size_t dim, real_t hdt)
+{
+	for (size_t i = 0; i < dim; ++i)
+	{
+		for (size_t j = 0; j < dim; ++j)
+		{
+			complex_t tmp = 0.0;
+			for (size_t k = 0; k < dim; ++k)
+			{
+				tmp += hamiltonian[i * dim + k] * in[k * dim + j]
+				     - in[i * dim + k] * hamiltonian[k * dim + j];
+			}
+			out[i * dim + j] -= complex_t(0.0, 1.0) * hdt * tmp;
+		}
+	}
+}
+
+// unoptimised/readable reference implementations for correctness validation
+void propagate_reference_rk4(complex_t* sigma, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, size_t num_steps)
+{
+	const size_t size_sigma = dim * dim;
+	real_t hdt = dt / hbar;
+
+	// iterate over all sigma matrices
+	#pragma omp parallel for
+	for (size_t n = 0; n < num_sigma; ++n)
+	{
+		complex_t* s = sigma + n * size_sigma;
+		std::vector<complex_t> k1(size_sigma), k2(size_sigma), k3(size_sigma), k4(size_sigma), y(size_sigma);
+		for (size_t step = 0; step < num_steps; ++step)
+		{
+			std::fill(k1.begin(), k1.end(), 0.0);
+			commutator_matrix_reference(s, k1.data(), hamiltonian, dim, hdt);
+			for (size_t i = 0; i < size_sigma; ++i)
+				y[i] = s[i] + real_t(0.5) * k1[i];
+			std::fill(k2.begin(), k2.end(), 0.0);
+			commutator_matrix_reference(y.data(), k2.data(), hamiltonian, dim, hdt);
+			for (size_t i = 0; i < size_sigma; ++i)
+				y[i] = s[i] + real_t(0.5) * k2[i];
+			std::fill(k3.begin(), k3.end(), 0.0);
+			commutator_matrix_reference(y.data(), k3.data(), hamiltonian, dim, hdt);
+			for (size_t i = 0; i < size_sigma; ++i)
+				y[i] = s[i] + k3[i];
+			std::fill(k4.begin(), k4.end(), 0.0);
+			commutator_matrix_reference(y.data(), k4.data(), hamiltonian, dim, hdt);
+			for (size_t i = 0; i < size_sigma; ++i)
+				s[i] += (k1[i] + real_t(2.0) * k2[i] + real_t(2.0) * k3[i] + k4[i]) / real_t(6.0);
+		}
+	}
+}
+
+void propagate_reference_lsrk(complex_t* sigma, complex_t* hamiltonian, size_t dim, size_t num_sigma, real_t hbar, real_t dt, size_t num_steps)
+{
+	const size_t size_sigma = dim * dim;
+	real_t hdt = dt / hbar;
+
+	// Carpenter and Kennedy (1994), 5 stages, 4th order
+	const size_t num_stages = 5;
+	const real_t a[num_stages] = { 0.0,
+	                               -567301805773.0 / 1357537059087.0,
+	                               -2404267990393.0 / 2016746695238.0,
+	                               -3550918686646.0 / 2091501179385.0,
+	                               -1275806237668.0 / 842570457699.0 };
+	const real_t b[num_stages] = { 1432997174477.0 / 9575080441755.0,
+	                               5161836677717.0 / 13612068292357.0,
+	                               1720146321549.0 / 2090206949498.0,
+	                               3134564353537.0 / 4481467310338.0,
+	                               2277821191437.0 / 14882151754819.0 };
+
+	// iterate over all sigma matrices
+	#pragma omp parallel for
+	for (size_t n = 0; n < num_sigma; ++n)
+	{
+		complex_t* s = sigma + n * size_sigma;
+		std::vector<complex_t> dq(size_sigma);
+		for (size_t step = 0; step < num_steps; ++step)
+		{
+			for (size_t stage = 0; stage < num_stages; ++stage)
+			{
+				for (size_t i = 0; i < size_sigma; ++i)
+					dq[i] *= a[stage];
+				commutator_matrix_reference(s, dq.data(), hamiltonian, dim, hdt);
+				for (size_t i = 0; i < size_sigma; ++i)
+					s[i] += b[stage] * dq[i];
+			}
+		}
+	}
+}
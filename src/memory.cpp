@@ -0,0 +1,342 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "memory.hpp"
+
+#include <algorithm> // min
+#include <cstdint> // uintptr_t
+#include <cstdio> // fopen, fgets
+#include <cstdlib> // getenv
+#include <cstring> // memset, strcmp
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <sys/mman.h> // mmap, madvise
+#include <unistd.h> // sysconf
+
+#ifdef USE_NUMA
+	#include <numa.h>
+	#include <numaif.h> // move_pages
+	#include <sched.h> // sched_getcpu
+#endif
+
+// page size flags of MAP_HUGETLB, not in older headers
+#ifndef MAP_HUGE_SHIFT
+	#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+	#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+	#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+namespace {
+
+const size_t huge_page_2m = 2 * 1024 * 1024;
+const size_t huge_page_1g = 1024 * 1024 * 1024;
+
+size_t page_size()
+{
+	static const size_t size = sysconf(_SC_PAGESIZE);
+	return size;
+}
+
+size_t round_up(size_t value, size_t multiple)
+{
+	return ((value + multiple - 1) / multiple) * multiple;
+}
+
+#ifdef USE_NUMA
+bool numa_enabled()
+{
+	static const bool enabled = (numa_available() >= 0);
+	return enabled;
+}
+#endif
+
+// zero all blocks with the static schedule of the kernels
+void first_touch(char* ptr, size_t bytes, size_t block_bytes)
+{
+	const long num_blocks = (bytes + block_bytes - 1) / block_bytes;
+	#pragma omp parallel for schedule(static)
+	for (long b = 0; b < num_blocks; ++b)
+		std::memset(ptr + b * block_bytes, 0, std::min(block_bytes, bytes - b * block_bytes));
+}
+
+// start and length of all mappings of allocate_huge_bytes(), for free_huge()
+std::map<void*, size_t> huge_mappings;
+std::mutex huge_mappings_mutex;
+
+// huge pages of the size selected by page_flag, nullptr if none are available
+void* map_hugetlb(size_t size, int page_flag)
+{
+	void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+	                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_flag, -1, 0);
+	return (ptr == MAP_FAILED) ? nullptr : ptr;
+}
+
+// normal pages, aligned to alignment by trimming a larger mapping
+void* map_aligned(size_t size, size_t alignment)
+{
+	const size_t length = size + alignment;
+	void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED)
+		return nullptr;
+	char* begin = static_cast<char*>(mapping);
+	char* ptr = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(begin), alignment));
+	if (ptr > begin)
+		munmap(begin, ptr - begin);
+	if (begin + length > ptr + size)
+		munmap(ptr + size, (begin + length) - (ptr + size));
+	return ptr;
+}
+
+// AnonHugePages (transparent huge pages) in KiB of the mapping containing ptr
+size_t anon_huge_pages_kib(void const* ptr)
+{
+	FILE* smaps = std::fopen("/proc/self/smaps", "r");
+	if (!smaps)
+		return 0;
+	const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+	bool in_mapping = false;
+	size_t kib = 0;
+	char line[512];
+	while (std::fgets(line, sizeof(line), smaps))
+	{
+		unsigned long begin, end, value;
+		if (std::sscanf(line, "%lx-%lx ", &begin, &end) == 2)
+			in_mapping = (begin <= address && address < end);
+		else if (in_mapping && std::sscanf(line, "AnonHugePages: %lu kB", &value) == 1)
+		{
+			kib = value;
+			break;
+		}
+	}
+	std::fclose(smaps);
+	return kib;
+}
+
+} // namespace
+
+const char* numa_placement_name(numa_placement placement)
+{
+	switch (placement)
+	{
+	case numa_placement::serial: return "serial";
+	case numa_placement::first_touch: return "first_touch";
+	case numa_placement::partition: return "partition";
+	case numa_placement::interleave: return "interleave";
+	}
+	return "unknown";
+}
+
+int numa_node_count()
+{
+#ifdef USE_NUMA
+	if (numa_enabled())
+		return numa_num_configured_nodes();
+#endif
+	return 1;
+}
+
+void numa_bind_thread(int node)
+{
+#ifdef USE_NUMA
+	if (numa_enabled())
+		numa_run_on_node(node);
+#endif
+}
+
+void* allocate_numa_bytes(size_t bytes, numa_placement placement, size_t block_bytes)
+{
+	// whole pages, no other allocation shares a page with this one
+	const size_t size = round_up(bytes, page_size());
+	char* ptr = allocate_aligned<char>(size, page_size());
+	if (!ptr)
+		return nullptr;
+
+#ifdef USE_NUMA
+	if (numa_enabled() && placement == numa_placement::partition)
+	{
+		// node k gets the blocks [k * B / N, (k + 1) * B / N), rounded to pages
+		const size_t num_blocks = (bytes + block_bytes - 1) / block_bytes;
+		const int num_nodes = numa_node_count();
+		for (int node = 0; node < num_nodes; ++node)
+		{
+			size_t begin = round_up((num_blocks * node / num_nodes) * block_bytes, page_size());
+			size_t end = round_up(std::min(bytes, (num_blocks * (node + 1) / num_nodes) * block_bytes), page_size());
+			if (begin < end)
+				numa_tonode_memory(ptr + begin, end - begin, node);
+		}
+	}
+	if (numa_enabled() && placement == numa_placement::interleave)
+		numa_interleave_memory(ptr, size, numa_all_nodes_ptr);
+#endif
+
+	if (placement == numa_placement::serial)
+		std::memset(ptr, 0, size);
+	else
+		first_touch(ptr, size, block_bytes);
+
+	return ptr;
+}
+
+void* allocate_numa_bytes_on_node(size_t bytes, int node)
+{
+	const size_t size = round_up(bytes, page_size());
+	char* ptr = allocate_aligned<char>(size, page_size());
+	if (!ptr)
+		return nullptr;
+#ifdef USE_NUMA
+	if (numa_enabled())
+		numa_tonode_memory(ptr, size, node);
+#endif
+	first_touch(ptr, size, page_size());
+	return ptr;
+}
+
+double numa_local_fraction(void const* ptr, size_t bytes, size_t block_bytes)
+{
+#ifdef USE_NUMA
+	if (!numa_enabled())
+		return 1.0;
+
+	const long num_blocks = (bytes + block_bytes - 1) / block_bytes;
+	const uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
+	long local = 0;
+	long total = 0;
+	#pragma omp parallel reduction(+:local, total)
+	{
+		const int node = numa_node_of_cpu(sched_getcpu());
+
+		// all pages of the blocks of this thread, same schedule as first_touch()
+		std::vector<void*> pages;
+		#pragma omp for schedule(static)
+		for (long b = 0; b < num_blocks; ++b)
+		{
+			uintptr_t begin = base + b * block_bytes;
+			uintptr_t end = base + std::min(bytes, (b + 1) * block_bytes);
+			for (uintptr_t page = begin - (begin % page_size()); page < end; page += page_size())
+				if (pages.empty() || pages.back() != reinterpret_cast<void*>(page))
+					pages.push_back(reinterpret_cast<void*>(page));
+		}
+
+		// nodes == nullptr only queries the node of each page
+		std::vector<int> status(pages.size());
+		if (!pages.empty() && move_pages(0, pages.size(), pages.data(), nullptr, status.data(), 0) == 0)
+		{
+			for (int s : status)
+				local += (s == node);
+			total += pages.size();
+		}
+	}
+	return total ? static_cast<double>(local) / total : 1.0;
+#else
+	return 1.0;
+#endif
+}
+
+const char* page_size_name(page_size_kind kind)
+{
+	switch (kind)
+	{
+	case page_size_kind::normal: return "4k";
+	case page_size_kind::transparent: return "thp";
+	case page_size_kind::huge_2m: return "2m";
+	case page_size_kind::huge_1g: return "1g";
+	}
+	return "unknown";
+}
+
+page_size_kind page_size_from_env()
+{
+	const char* pages = std::getenv("HEXCITON_PAGES");
+	if (!pages || pages[0] == '\0')
+		return page_size_kind::normal;
+	for (page_size_kind kind : { page_size_kind::normal, page_size_kind::transparent,
+	                             page_size_kind::huge_2m, page_size_kind::huge_1g })
+		if (std::strcmp(pages, page_size_name(kind)) == 0)
+			return kind;
+	std::cerr << "Warning: unknown HEXCITON_PAGES=" << pages << ", using 4k pages." << std::endl;
+	return page_size_kind::normal;
+}
+
+void* allocate_huge_bytes(size_t bytes, page_size_kind kind, size_t* page_bytes, size_t block_bytes)
+{
+	void* ptr = nullptr;
+	size_t size = 0;
+	size_t obtained = page_size();
+
+	// fall through to the next smaller page size if the huge pages are not
+	// available (none reserved)
+	switch (kind)
+	{
+	case page_size_kind::huge_1g:
+		size = round_up(bytes, huge_page_1g);
+		if ((ptr = map_hugetlb(size, MAP_HUGE_1GB)))
+		{
+			obtained = huge_page_1g;
+			break;
+		}
+		std::cerr << "Warning: no 1 GiB huge pages available, trying 2 MiB." << std::endl;
+		// fall through
+	case page_size_kind::huge_2m:
+		size = round_up(bytes, huge_page_2m);
+		if ((ptr = map_hugetlb(size, MAP_HUGE_2MB)))
+		{
+			obtained = huge_page_2m;
+			break;
+		}
+		std::cerr << "Warning: no 2 MiB huge pages available, trying transparent huge pages." << std::endl;
+		// fall through
+	case page_size_kind::transparent:
+		size = round_up(bytes, huge_page_2m);
+		if ((ptr = map_aligned(size, huge_page_2m)))
+			madvise(ptr, size, MADV_HUGEPAGE);
+		break;
+	case page_size_kind::normal:
+		size = round_up(bytes, page_size());
+		ptr = map_aligned(size, page_size());
+		break;
+	}
+
+	if (!ptr)
+	{
+		std::cerr << "Error: mmap() failed for " << bytes << " bytes." << std::endl;
+		return nullptr;
+	}
+
+	first_touch(static_cast<char*>(ptr), size, block_bytes);
+
+	// transparent huge pages are only known after the first touch
+	if (obtained == page_size() && kind != page_size_kind::normal && anon_huge_pages_kib(ptr) > 0)
+		obtained = huge_page_2m;
+
+	{
+		std::lock_guard<std::mutex> lock(huge_mappings_mutex);
+		huge_mappings[ptr] = size;
+	}
+
+	if (page_bytes)
+		*page_bytes = obtained;
+	return ptr;
+}
+
+void free_huge(void* ptr)
+{
+	if (!ptr)
+		return;
+	std::lock_guard<std::mutex> lock(huge_mappings_mutex);
+	auto mapping = huge_mappings.find(ptr);
+	if (mapping == huge_mappings.end())
+	{
+		std::cerr << "Error: free_huge() called for memory not from allocate_huge()." << std::endl;
+		return;
+	}
+	munmap(mapping->first, mapping->second);
+	huge_mappings.erase(mapping);
+}
@@ -0,0 +1,274 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ocl_program_cache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio> // rename, remove
+#include <cstdlib> // getenv
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <sys/stat.h> // mkdir
+#include <unistd.h> // getpid
+
+namespace {
+
+const char* cache_magic = "hexciton_ocl_program_cache 1";
+
+ocl_program_cache_statistics stats = {};
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool read_file(const std::string& file_name, std::string& content)
+{
+	std::ifstream file(file_name, std::ios::binary);
+	if (!file)
+		return false;
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	content = buffer.str();
+	return true;
+}
+
+std::string directory_of(const std::string& file_name)
+{
+	size_t pos = file_name.find_last_of('/');
+	return (pos == std::string::npos) ? "." : file_name.substr(0, pos);
+}
+
+// -I paths of the compile options, "-Ipath" and "-I path"
+std::vector<std::string> include_paths(const std::string& compile_options)
+{
+	std::vector<std::string> paths;
+	std::istringstream options(compile_options);
+	std::string option;
+	while (options >> option)
+	{
+		if (option == "-I" && options >> option)
+			paths.push_back(option);
+		else if (option.compare(0, 2, "-I") == 0)
+			paths.push_back(option.substr(2));
+	}
+	return paths;
+}
+
+// appends the contents of file_name and of all files it includes to key
+void append_sources(const std::string& file_name, std::vector<std::string> const& paths,
+                    std::set<std::string>& visited, std::string& key)
+{
+	std::string source;
+	if (!visited.insert(file_name).second || !read_file(file_name, source))
+		return;
+	key += "source " + file_name + " " + std::to_string(source.size()) + "\n" + source + "\n";
+
+	std::istringstream lines(source);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		size_t hash = line.find_first_not_of(" \t");
+		if (hash == std::string::npos || line[hash] != '#')
+			continue;
+		size_t include = line.find_first_not_of(" \t", hash + 1);
+		if (include == std::string::npos || line.compare(include, 7, "include") != 0)
+			continue;
+		size_t begin = line.find('"', include);
+		size_t end = (begin == std::string::npos) ? begin : line.find('"', begin + 1);
+		if (end == std::string::npos)
+			continue; // system include or malformed, ignored
+		std::string name = line.substr(begin + 1, end - begin - 1);
+
+		// same search order as the compiler: own directory first, then -I
+		std::vector<std::string> candidates(1, directory_of(file_name) + "/" + name);
+		for (const std::string& path : paths)
+			candidates.push_back(path + "/" + name);
+		for (const std::string& candidate : candidates)
+		{
+			if (std::ifstream(candidate))
+			{
+				append_sources(candidate, paths, visited, key);
+				break;
+			}
+		}
+	}
+}
+
+std::string device_string(cl_device_id device, cl_device_info param)
+{
+	size_t size = 0;
+	if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+		return "";
+	std::vector<char> value(size);
+	if (clGetDeviceInfo(device, param, size, value.data(), nullptr) != CL_SUCCESS)
+		return "";
+	return std::string(value.data());
+}
+
+// FNV-1a, 64 bit
+uint64_t hash_string(const std::string& s)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : s)
+	{
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::string cache_file_name(const std::string& directory, const std::string& key)
+{
+	char hex[17];
+	std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash_string(key)));
+	return directory + "/" + hex + ".bin";
+}
+
+// returns an empty binary if there is no entry for key
+std::vector<unsigned char> load_binary(const std::string& cache_file, const std::string& key)
+{
+	std::ifstream file(cache_file, std::ios::binary);
+	std::string magic;
+	size_t key_size = 0, binary_size = 0;
+	if (!file || !std::getline(file, magic) || magic != cache_magic || !(file >> key_size) || file.get() != '\n')
+		return std::vector<unsigned char>();
+	std::string stored_key(key_size, '\0');
+	if (!file.read(&stored_key[0], key_size) || stored_key != key || !(file >> binary_size) || file.get() != '\n')
+		return std::vector<unsigned char>();
+	std::vector<unsigned char> binary(binary_size);
+	if (!file.read(reinterpret_cast<char*>(binary.data()), binary_size))
+		return std::vector<unsigned char>();
+	return binary;
+}
+
+void store_binary(const std::string& directory, const std::string& cache_file, const std::string& key,
+                  cl_program program, cl_device_id device)
+{
+	// the binary of device among all devices of the program
+	cl_uint num_devices = 0;
+	if (clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &num_devices, nullptr) != CL_SUCCESS || num_devices == 0)
+		return;
+	std::vector<cl_device_id> devices(num_devices);
+	std::vector<size_t> sizes(num_devices);
+	if (clGetProgramInfo(program, CL_PROGRAM_DEVICES, sizeof(cl_device_id) * num_devices, devices.data(), nullptr) != CL_SUCCESS
+	    || clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t) * num_devices, sizes.data(), nullptr) != CL_SUCCESS)
+		return;
+	std::vector<std::vector<unsigned char>> binaries(num_devices);
+	std::vector<unsigned char*> pointers(num_devices);
+	for (cl_uint i = 0; i < num_devices; ++i)
+	{
+		binaries[i].resize(sizes[i]);
+		pointers[i] = binaries[i].data();
+	}
+	if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char*) * num_devices, pointers.data(), nullptr) != CL_SUCCESS)
+		return;
+	cl_uint index = 0;
+	while (index < num_devices && devices[index] != device)
+		++index;
+	if (index == num_devices || binaries[index].empty())
+		return;
+
+	// write to a temporary file first, concurrent runs never see partial entries,
+	// the name is unique per process (pid) and per call within it (counter)
+	static std::atomic<unsigned> tmp_counter(0);
+	mkdir(directory.c_str(), 0755);
+	const std::string tmp_file = cache_file + ".tmp" + std::to_string(getpid()) + "." + std::to_string(tmp_counter++);
+	{
+		std::ofstream file(tmp_file, std::ios::binary);
+		file << cache_magic << "\n" << key.size() << "\n" << key << binaries[index].size() << "\n";
+		file.write(reinterpret_cast<const char*>(binaries[index].data()), binaries[index].size());
+		if (!file)
+		{
+			std::cerr << "Warning: could not write OpenCL program cache file: " << tmp_file << std::endl;
+			std::remove(tmp_file.c_str());
+			return;
+		}
+	}
+	if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0)
+		std::remove(tmp_file.c_str());
+}
+
+} // namespace
+
+cl_program ocl_build_program_cached(cl_context context, cl_device_id device,
+                                    const std::string& file_name, const std::string& compile_options,
+                                    cl_int* err)
+{
+	const char* env_directory = std::getenv("HEXCITON_OCL_CACHE");
+	const std::string directory = env_directory ? env_directory : ".ocl_cache";
+	const bool use_cache = !directory.empty();
+
+	std::string source;
+	if (!read_file(file_name, source))
+	{
+		std::cerr << "Error: could not read OpenCL source: " << file_name << std::endl;
+		*err = CL_INVALID_VALUE;
+		return nullptr;
+	}
+
+	// key: device, driver, options, sources
+	std::string key = "device " + device_string(device, CL_DEVICE_NAME) + "\n"
+	                + "vendor " + device_string(device, CL_DEVICE_VENDOR) + "\n"
+	                + "version " + device_string(device, CL_DEVICE_VERSION) + "\n"
+	                + "driver " + device_string(device, CL_DRIVER_VERSION) + "\n"
+	                + "options " + compile_options + "\n";
+	std::set<std::string> visited;
+	append_sources(file_name, include_paths(compile_options), visited, key);
+	const std::string cache_file = cache_file_name(directory, key);
+
+	// hit: create from binary, which still needs clBuildProgram()
+	if (use_cache)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::vector<unsigned char> binary = load_binary(cache_file, key);
+		if (!binary.empty())
+		{
+			const unsigned char* binary_ptr = binary.data();
+			const size_t binary_size = binary.size();
+			cl_int binary_status = CL_SUCCESS;
+			cl_program program = clCreateProgramWithBinary(context, 1, &device, &binary_size, &binary_ptr, &binary_status, err);
+			if (*err == CL_SUCCESS && binary_status == CL_SUCCESS)
+				*err = clBuildProgram(program, 1, &device, compile_options.c_str(), nullptr, nullptr);
+			if (*err == CL_SUCCESS && binary_status == CL_SUCCESS)
+			{
+				++stats.hits;
+				stats.load_ms += elapsed_ms(start);
+				return program;
+			}
+			// rejected, e.g. after a driver update with unchanged version string
+			if (program)
+				clReleaseProgram(program);
+		}
+	}
+
+	// miss: build from source
+	auto start = std::chrono::steady_clock::now();
+	const char* source_ptr = source.c_str();
+	const size_t source_size = source.size();
+	cl_program program = clCreateProgramWithSource(context, 1, &source_ptr, &source_size, err);
+	if (*err != CL_SUCCESS)
+		return program;
+	*err = clBuildProgram(program, 1, &device, compile_options.c_str(), nullptr, nullptr);
+	if (*err != CL_SUCCESS)
+		return program; // for the build log
+	++stats.misses;
+	stats.build_ms += elapsed_ms(start);
+
+	if (use_cache)
+		store_binary(directory, cache_file, key, program, device);
+	return program;
+}
+
+ocl_program_cache_statistics const& ocl_program_cache_stats()
+{
+	return stats;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ocl_source_generator.hpp"
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// literal that reads back to exactly value
+std::string real_literal(real_t value)
+{
+	std::ostringstream literal;
+	literal << std::scientific << std::setprecision(std::numeric_limits<real_t>::max_digits10) << value;
+#ifdef SINGLE_PRECISION
+	literal << "f";
+#endif
+	return literal.str();
+}
+
+std::string sigma_variable(const char* part, size_t i, size_t j)
+{
+	return std::string("s") + part + "_" + std::to_string(i) + "_" + std::to_string(j);
+}
+
+// emits: target += sum of coefficients[m] * sigma_in element m, marks the
+// elements in used, returns the number of terms
+size_t emit_sum(std::ostringstream& source, const std::string& target,
+                std::vector<real_t> const& coefficients, std::vector<bool>& used, size_t dim)
+{
+	size_t terms = 0;
+	for (size_t m = 0; m < coefficients.size(); ++m)
+	{
+		if (coefficients[m] == 0.0)
+			continue;
+		// elements: dim * dim real parts followed by dim * dim imaginary parts
+		const size_t e = m % (dim * dim);
+		used[m] = true;
+		source << (terms == 0 ? "\t" + target + " += " : "\n\t\t+ ")
+		       << real_literal(coefficients[m]) << " * "
+		       << sigma_variable(m < dim * dim ? "r" : "i", e / dim, e % dim);
+		++terms;
+	}
+	if (terms > 0)
+		source << ";\n";
+	return terms;
+}
+
+} // namespace
+
+ocl_generated_source ocl_generate_commutator_source(const std::string& kernel_name,
+                                                    complex_t const* hamiltonian, size_t dim)
+{
+	ocl_generated_source generated = { "", 0, 8 * dim * dim * dim };
+	std::ostringstream source;
+
+	source << "// generated by ocl_generate_commutator_source() for DIM=" << dim << "\n"
+	       << "\n"
+	       << "#include \"kernel/common.cl\"\n"
+	       << "\n"
+	       << "__kernel __attribute__((vec_type_hint(real_vec_t)))\n"
+	       << "void " << kernel_name << "(__global real_vec_t const* restrict sigma_in,\n"
+	       << "\t__global real_vec_t* restrict sigma_out,\n"
+	       << "\t__global real_t const* restrict hamiltonian,\n"
+	       << "\tconst int num, const int dim,\n"
+	       << "\tconst real_t hbar, const real_t dt)\n"
+	       << "{\n"
+	       << "\t// number of package to process == get_global_id(0)\n"
+	       << "\t__global real_vec_t const* restrict in = sigma_in + get_global_id(0) * " << 2 * dim * dim << ";\n"
+	       << "\t__global real_vec_t* restrict out = sigma_out + get_global_id(0) * " << 2 * dim * dim << ";\n"
+	       << "\n";
+
+	// commutator: -i * (H * sigma - sigma * H), per element (i, j) the
+	// coefficients of all sigma_in elements, real parts first
+	auto h_real = [&](size_t i, size_t j) { return hamiltonian[i * dim + j].real(); }; // lambda expression
+	auto h_imag = [&](size_t i, size_t j) { return hamiltonian[i * dim + j].imag(); }; // lambda expression
+	const size_t size = dim * dim;
+	std::vector<bool> used(2 * size, false);
+	std::ostringstream body;
+	for (size_t i = 0; i < dim; ++i)
+	{
+		for (size_t j = 0; j < dim; ++j)
+		{
+			std::vector<real_t> coefficients_real(2 * size, 0.0);
+			std::vector<real_t> coefficients_imag(2 * size, 0.0);
+			for (size_t k = 0; k < dim; ++k)
+			{
+				// same terms as commutator_ocl_manual_aosoa_constants
+				coefficients_imag[k * dim + j] -= h_real(i, k);
+				coefficients_imag[i * dim + k] += h_real(k, j);
+				coefficients_imag[size + k * dim + j] += h_imag(i, k);
+				coefficients_imag[size + i * dim + k] -= h_imag(k, j);
+				coefficients_real[size + k * dim + j] += h_real(i, k);
+				coefficients_real[i * dim + k] -= h_imag(k, j);
+				coefficients_real[k * dim + j] += h_imag(i, k);
+				coefficients_real[size + i * dim + k] -= h_real(k, j);
+			}
+			const size_t index = 2 * (dim * i + j);
+			generated.num_terms += emit_sum(body, "out[" + std::to_string(index) + "]", coefficients_real, used, dim);
+			generated.num_terms += emit_sum(body, "out[" + std::to_string(index + 1) + "]", coefficients_imag, used, dim);
+		}
+	}
+
+	// load the used elements of the package
+	for (size_t i = 0; i < dim; ++i)
+	{
+		for (size_t j = 0; j < dim; ++j)
+		{
+			if (used[i * dim + j])
+				source << "\tconst real_vec_t " << sigma_variable("r", i, j) << " = in[" << 2 * (dim * i + j) << "];\n";
+			if (used[size + i * dim + j])
+				source << "\tconst real_vec_t " << sigma_variable("i", i, j) << " = in[" << 2 * (dim * i + j) + 1 << "];\n";
+		}
+	}
+	source << "\n" << body.str() << "}\n";
+
+	generated.source = source.str();
+	return generated;
+}
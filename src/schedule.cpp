@@ -0,0 +1,158 @@
+// Copyright (c) 2015 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "schedule.hpp"
+
+#include <algorithm> // min, max
+#include <cstdlib> // free
+#include <new> // placement new
+
+#include <omp.h>
+
+const char* schedule_name(schedule_kind kind)
+{
+	switch (kind)
+	{
+	case schedule_kind::omp_static: return "static";
+	case schedule_kind::omp_dynamic: return "dynamic";
+	case schedule_kind::omp_guided: return "guided";
+	case schedule_kind::work_stealing: return "work_stealing";
+	}
+	return "unknown";
+}
+
+int cache_chunk_packages(size_t bytes_per_package, size_t cache_bytes)
+{
+	return std::max<int>(1, static_cast<int>(cache_bytes / bytes_per_package));
+}
+
+// Deque of chunk indices [front, back) of one thread, both packed into one
+// 64 bit word, i.e. the owner (takes from the front) and the thieves (take
+// from the back) synchronise with a single compare-and-swap.
+// NOTE: chunks are only ever removed, an empty deque is only refilled by its
+//       owner with stolen chunks
+struct alignas(64) chunk_deque // one cache line per deque, no false sharing
+{
+	std::atomic<uint64_t> range;
+
+	static uint64_t pack(uint32_t front, uint32_t back) { return (static_cast<uint64_t>(front) << 32) | back; }
+	static uint32_t front(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+	static uint32_t back(uint64_t range) { return static_cast<uint32_t>(range); }
+
+	// owner: take the first chunk, returns false if empty
+	bool pop(uint32_t& chunk)
+	{
+		uint64_t old_range = range.load();
+		while (front(old_range) < back(old_range))
+		{
+			if (range.compare_exchange_weak(old_range, pack(front(old_range) + 1, back(old_range))))
+			{
+				chunk = front(old_range);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// thief: take the last half of the chunks, returns false if empty
+	bool steal(uint32_t& first, uint32_t& last)
+	{
+		uint64_t old_range = range.load();
+		while (front(old_range) < back(old_range))
+		{
+			uint32_t count = (back(old_range) - front(old_range) + 1) / 2;
+			if (range.compare_exchange_weak(old_range, pack(front(old_range), back(old_range) - count)))
+			{
+				first = back(old_range) - count;
+				last = back(old_range);
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+void schedule_packages(schedule const& s, int num_packages, size_t bytes_per_package,
+                       std::function<void(int first, int last)> const& body,
+                       double* busy_time)
+{
+	const int chunk_packages = (s.chunk_packages > 0) ? s.chunk_packages : cache_chunk_packages(bytes_per_package);
+	const int num_chunks = (num_packages + chunk_packages - 1) / chunk_packages;
+	const int num_threads = omp_get_max_threads();
+
+	// the team may be smaller than num_threads, threads that do not run report 0
+	if (busy_time)
+		std::fill(busy_time, busy_time + num_threads, 0.0);
+
+	// NOTE: allocate_aligned, the alignment of chunk_deque exceeds the one of new in C++14,
+	//       the deques are constructed in place and destroyed before free
+	chunk_deque* deques = nullptr;
+	if (s.kind == schedule_kind::work_stealing)
+		deques = allocate_aligned<chunk_deque>(num_threads);
+	// initial distribution: contiguous blocks of chunks, as with schedule(static)
+	for (int t = 0; deques && t < num_threads; ++t)
+		new (deques + t) chunk_deque { { chunk_deque::pack(static_cast<uint32_t>((static_cast<int64_t>(num_chunks) * t) / num_threads),
+		                                                   static_cast<uint32_t>((static_cast<int64_t>(num_chunks) * (t + 1)) / num_threads)) } };
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		const int thread = omp_get_thread_num();
+		double busy = 0.0;
+
+		auto run_chunk = [&](int chunk)
+		{
+			double start = omp_get_wtime();
+			body(chunk * chunk_packages, std::min(num_packages, (chunk + 1) * chunk_packages));
+			busy += omp_get_wtime() - start;
+		};
+
+		switch (s.kind)
+		{
+		case schedule_kind::omp_static:
+			#pragma omp for schedule(static)
+			for (int chunk = 0; chunk < num_chunks; ++chunk)
+				run_chunk(chunk);
+			break;
+		case schedule_kind::omp_dynamic:
+			#pragma omp for schedule(dynamic, 1)
+			for (int chunk = 0; chunk < num_chunks; ++chunk)
+				run_chunk(chunk);
+			break;
+		case schedule_kind::omp_guided:
+			#pragma omp for schedule(guided, 1)
+			for (int chunk = 0; chunk < num_chunks; ++chunk)
+				run_chunk(chunk);
+			break;
+		case schedule_kind::work_stealing:
+		{
+			chunk_deque& own = deques[thread];
+			uint32_t chunk, first, last;
+			for (;;)
+			{
+				while (own.pop(chunk))
+					run_chunk(chunk);
+
+				// own deque is empty: steal from the other threads, round robin
+				bool stolen = false;
+				for (int i = 1; i < num_threads && !stolen; ++i)
+					stolen = deques[(thread + i) % num_threads].steal(first, last);
+				if (!stolen)
+					break; // all deques are empty, no chunks are ever added
+				// run the first stolen chunk, keep the rest stealable
+				own.range = chunk_deque::pack(first + 1, last);
+				run_chunk(first);
+			}
+			break;
+		}
+		}
+
+		if (busy_time)
+			busy_time[thread] = busy;
+	}
+
+	for (int t = 0; deques && t < num_threads; ++t)
+		deques[t].~chunk_deque();
+	free(deques);
+}